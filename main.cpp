@@ -4,6 +4,7 @@
 #include "skCrypt.hpp"
 #include "offsets.hpp"
 #include "other/overlay/overlay.hpp"
+#include "other/configs/globals.h"
 
 HMODULE(WINAPI* _LoadLibraryExWAuto) (LPCWSTR, HANDLE, DWORD) = nullptr;
 
@@ -73,6 +74,38 @@ extern "C" HMODULE WINAPI _LoadLibraryExWHook(LPCWSTR Module, HANDLE File, DWORD
 
                 printf(Ta.get());
             }
+
+            // Float entry point, for voice module builds that encode float frames
+            if (utilities::globals::opusencodefloat) {
+                MH_CreateHook((char*)VoiceEngine + utilities::globals::opusencodefloat,
+                    custom_opus_encode_float,
+                    0);
+            }
+
+            // Multistream entry points, surround audio gets the effects per channel group
+            if (utilities::globals::opusmultistreamencode) {
+                MH_CreateHook((char*)VoiceEngine + utilities::globals::opusmultistreamencode,
+                    custom_opus_multistream_encode,
+                    0);
+            }
+            if (utilities::globals::opusmultistreamencodefloat) {
+                MH_CreateHook((char*)VoiceEngine + utilities::globals::opusmultistreamencodefloat,
+                    custom_opus_multistream_encode_float,
+                    0);
+            }
+
+            // Frees the per-encoder DSP state with the encoder, unused streams are evicted otherwise
+            if (utilities::globals::opusencoderdestroy) {
+                MH_CreateHook((char*)VoiceEngine + utilities::globals::opusencoderdestroy,
+                    custom_opus_encoder_destroy,
+                    (void**)&original_opus_encoder_destroy);
+            }
+            // Receive side, incoming voices go through the per-stream receive chain
+            if (utilities::globals::opusdecode) {
+                MH_CreateHook((char*)VoiceEngine + utilities::globals::opusdecode,
+                    custom_opus_decode,
+                    (void**)&original_opus_decode);
+            }
             MH_CreateHook((char*)VoiceEngine + 0x46869C, returnzero, 0); // high pass
             MH_CreateHook((char*)VoiceEngine + 0x2EF820, returnzero, 0); // ProcessStream_AudioFrame
             MH_CreateHook((char*)VoiceEngine + 0x2EDFC0, returnzero, 0); // ProcessStream_StreamConfig
@@ -2,7 +2,11 @@
 
 int utilities::globals::highpass = 0x465686;
 int utilities::globals::opusencode = 0x863E90;
+int utilities::globals::opusencodefloat = 0; // not located yet, 0 = hook disabled
+int utilities::globals::opusmultistreamencode = 0; // not located yet, 0 = hook disabled
+int utilities::globals::opusmultistreamencodefloat = 0; // not located yet, 0 = hook disabled
 int utilities::globals::opusdecode = 0x867BA0;
+int utilities::globals::opusencoderdestroy = 0; // not located yet, 0 = hook disabled
 
 float utilities::globals::gain = 1.0f;
 
@@ -4,7 +4,11 @@ namespace utilities {
 	struct globals {
 		static int highpass;
 		static int opusencode;
+		static int opusencodefloat;
+		static int opusmultistreamencode;
+		static int opusmultistreamencodefloat;
 		static int opusdecode;
+		static int opusencoderdestroy;
 		
 		static float gain;
 
@@ -0,0 +1,134 @@
+#include "autoGain.hpp"
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For expf, powf, log10
+
+namespace {
+    // One-pole coefficient for a time constant, updated once per step of stepMs
+    inline float SmoothingCoeff(float timeMs, float stepMs) {
+        return 1.0f - expf(-stepMs / std::max(timeMs, stepMs));
+    }
+}
+
+void AutoGainControl::configure(int rate, int numChannels) {
+    rate = std::max(8000, rate);
+    numChannels = std::max(1, std::min(numChannels, MAX_CHANNELS));
+    if (rate == sampleRate && numChannels == channels) return;
+
+    sampleRate = rate;
+    channels = numChannels;
+    subBlockLength = std::max(1, (int)(sampleRate * SUB_BLOCK_MS / 1000.0f));
+
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+        weighting[ch].design(sampleRate);
+    }
+
+    updateCoefficients();
+    reset();
+}
+
+void AutoGainControl::setParams(float target, float attack, float release, float hold) {
+    if (target == targetLufs && attack == attackMs && release == releaseMs && hold == holdMs) return;
+
+    targetLufs = target;
+    attackMs = attack;
+    releaseMs = release;
+    holdMs = hold;
+    updateCoefficients();
+}
+
+void AutoGainControl::updateCoefficients() {
+    loudnessCoeff = SmoothingCoeff(LOUDNESS_WINDOW_MS, SUB_BLOCK_MS);
+    peakReleaseCoeff = SmoothingCoeff(PEAK_RELEASE_MS, SUB_BLOCK_MS);
+    attackCoeff = SmoothingCoeff(attackMs, SUB_BLOCK_MS);
+    releaseCoeff = SmoothingCoeff(releaseMs, SUB_BLOCK_MS);
+    holdBlocks = std::max(0, (int)(holdMs / SUB_BLOCK_MS));
+}
+
+void AutoGainControl::reset() {
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+        weighting[ch].reset();
+    }
+
+    subBlockFill = 0;
+    subBlockEnergy = 0.0;
+    subBlockPeak = 0.0f;
+    loudnessEnergy = 0.0;
+    peakEnvelope = 0.0f;
+
+    gainDb = 0.0f;
+    holdRemaining = 0;
+    gain = 1.0f;
+    gainStep = 0.0f;
+    publishedGainDb.store(0.0f, std::memory_order_relaxed);
+}
+
+// Fold the finished sub-block into the detectors and plan the gain ramp for the next one
+void AutoGainControl::startSubBlock() {
+    if (subBlockFill > 0) {
+        double energy = subBlockEnergy / subBlockFill;
+        loudnessEnergy += loudnessCoeff * (energy - loudnessEnergy);
+
+        // Peak follower: instant attack, smooth release
+        peakEnvelope = subBlockPeak > peakEnvelope ? subBlockPeak
+                                                   : peakEnvelope + peakReleaseCoeff * (subBlockPeak - peakEnvelope);
+    }
+
+    subBlockFill = 0;
+    subBlockEnergy = 0.0;
+    subBlockPeak = 0.0f;
+
+    float loudnessLufs = loudnessEnergy > 1e-12 ? (float)(-0.691 + 10.0 * log10(loudnessEnergy)) : -120.0f;
+
+    // Only move towards the target while there is actual signal, hold through silence
+    if (loudnessLufs > GATE_LUFS) {
+        float desiredDb = std::max(MIN_GAIN_DB, std::min(targetLufs - loudnessLufs, MAX_GAIN_DB));
+
+        if (desiredDb < gainDb) {
+            gainDb += attackCoeff * (desiredDb - gainDb);
+            holdRemaining = holdBlocks;
+        }
+        else if (holdRemaining > 0) {
+            holdRemaining--;
+        }
+        else {
+            gainDb += releaseCoeff * (desiredDb - gainDb);
+        }
+    }
+
+    // Fast peak guard on top of the loudness gain
+    float outputDb = gainDb;
+    if (peakEnvelope > 1e-6f) {
+        outputDb = std::min(outputDb, 20.0f * log10f(PEAK_CEILING / peakEnvelope));
+    }
+
+    // Ramp linearly to the new gain over this sub-block
+    float nextGain = powf(10.0f, outputDb / 20.0f);
+    gainStep = (nextGain - gain) / subBlockLength;
+    publishedGainDb.store(outputDb, std::memory_order_relaxed);
+}
+
+void AutoGainControl::process(float* buffer, int frames) {
+    if (!buffer || frames <= 0 || channels <= 0) return;
+
+    int i = 0;
+    while (i < frames) {
+        if (subBlockFill == 0 || subBlockFill >= subBlockLength) {
+            startSubBlock();
+        }
+
+        int count = std::min(frames - i, subBlockLength - subBlockFill);
+        for (int n = 0; n < count; n++, i++) {
+            float* frame = buffer + i * channels;
+            gain += gainStep;
+
+            for (int ch = 0; ch < channels; ch++) {
+                float x = frame[ch];
+                double weighted = weighting[ch].process(x);
+                subBlockEnergy += weighted * weighted;
+                subBlockPeak = std::max(subBlockPeak, fabsf(x));
+                frame[ch] = x * gain;
+            }
+        }
+        subBlockFill += count;
+    }
+}
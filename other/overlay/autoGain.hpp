@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include "loudnessMeter.hpp"
+
+// AutoGainControl - drives the signal towards a target loudness (LUFS).
+//
+// The input is K-weighted and measured in 5 ms sub-blocks. A slow loudness
+// estimate (~400 ms) sets the desired gain, which moves with separate attack and
+// release times and is held for a while after every reduction so speech pauses
+// don't pump. A fast peak follower caps the gain so loud transients aren't pushed
+// into the limiter. The gain is recomputed once per sub-block and ramped linearly
+// across it, so the per-sample cost is constant: K-weighting plus one multiply.
+class AutoGainControl {
+public:
+    static constexpr int MAX_CHANNELS = 2;
+    static constexpr float MIN_GAIN_DB = -30.0f;
+    static constexpr float MAX_GAIN_DB = 50.0f;
+
+    AutoGainControl() = default;
+
+    // Set format, resets the state when it changes
+    void configure(int sampleRate, int numChannels);
+
+    // Target loudness and timing. Cheap when nothing changed, can be called every block.
+    void setParams(float targetLufs, float attackMs, float releaseMs, float holdMs);
+
+    void reset();
+
+    // Apply the gain to a block of interleaved audio in place
+    void process(float* buffer, int frames);
+
+    // Gain currently applied in dB, safe to read from any thread
+    float getGainDb() const { return publishedGainDb.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr float SUB_BLOCK_MS = 5.0f;
+    static constexpr float LOUDNESS_WINDOW_MS = 400.0f;
+    static constexpr float PEAK_RELEASE_MS = 150.0f;
+    static constexpr float PEAK_CEILING = 0.9f;    // Peak guard keeps transients around -1 dBFS
+    static constexpr float GATE_LUFS = -50.0f;     // Below this the input counts as silence
+
+    KWeightingFilter weighting[MAX_CHANNELS];
+
+    // Current sub-block
+    int subBlockLength = 240;
+    int subBlockFill = 0;
+    double subBlockEnergy = 0.0;
+    float subBlockPeak = 0.0f;
+
+    // Detectors
+    double loudnessEnergy = 0.0;   // Smoothed K-weighted mean square
+    float peakEnvelope = 0.0f;
+
+    // Gain state
+    float gainDb = 0.0f;           // Follows the loudness target (attack/release/hold)
+    int holdRemaining = 0;         // Sub-blocks left before the gain may rise again
+    float gain = 1.0f;             // Linear gain applied to the current sample
+    float gainStep = 0.0f;         // Per-sample increment across the current sub-block
+
+    // Per sub-block smoothing coefficients
+    float loudnessCoeff = 0.0f;
+    float peakReleaseCoeff = 0.0f;
+    float attackCoeff = 0.0f;
+    float releaseCoeff = 0.0f;
+    int holdBlocks = 0;
+
+    float targetLufs = -16.0f;
+    float attackMs = -1.0f;
+    float releaseMs = -1.0f;
+    float holdMs = -1.0f;
+
+    int sampleRate = 0;
+    int channels = 0;
+
+    std::atomic<float> publishedGainDb{ 0.0f };
+
+    void updateCoefficients();
+    void startSubBlock();
+};
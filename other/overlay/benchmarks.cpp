@@ -0,0 +1,929 @@
+#include "benchmarks.hpp"
+#include "encoderCtlCache.hpp"
+#include "framePacker.hpp"
+#include "jitterBuffer.hpp"
+#include "lossSimulator.hpp"
+#include "packetRecorder.hpp"
+#include "streamMixer.hpp"
+#include "libraries/opus/include/opus.h"
+#include <algorithm> // For std::min
+#include <chrono>
+#include <cmath>     // For sinf, log10
+#include <cstdio>    // For snprintf
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+const char* const BenchmarkRunner::NAMES[(int)BenchmarkId::Count] = {
+    "Encoder ctl cache",
+    "FEC / packet loss",
+    "Frame duration",
+    "Effect matrix",
+    "Incoming mix",
+    "Jitter buffer"
+};
+
+namespace {
+    constexpr int BENCH_SAMPLE_RATE = 48000;
+    constexpr int BENCH_CHANNELS = 2;
+    constexpr int BENCH_FRAME_SIZE = 960;     // 20 ms
+    constexpr int BENCH_FRAMES = 1500;        // 30 s of audio per run
+    constexpr int BENCH_ROUNDS = 3;           // Best of, runs alternate between variants
+    constexpr int BENCH_MAX_PACKET = 1500;
+
+    double NowUs() {
+        using namespace std::chrono;
+        return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Voiced-speech stand-in: a 140 Hz harmonic series with a 4 Hz syllable envelope
+    // and a little noise, slightly different per channel. Deterministic, so every
+    // run encodes exactly the same input.
+    std::vector<opus_int16> MakeSpeechLikeSignal(int frames, int channels, int sampleRate) {
+        std::vector<opus_int16> pcm((size_t)frames * channels);
+        unsigned int noise = 0x12345678u;
+        for (int i = 0; i < frames; i++) {
+            float t = (float)i / sampleRate;
+            float syllable = 0.5f - 0.5f * cosf(2.0f * 3.14159265f * 4.0f * t);
+            float voiced = 0.0f;
+            for (int h = 1; h <= 12; h++) {
+                voiced += sinf(2.0f * 3.14159265f * 140.0f * h * t) / h;
+            }
+            for (int ch = 0; ch < channels; ch++) {
+                noise = noise * 1664525u + 1013904223u;
+                float hiss = ((int)(noise >> 16) - 32768) / 32768.0f * 0.02f;
+                float sample = (voiced * (0.9f + 0.1f * ch) * syllable * 0.25f) + hiss;
+                pcm[(size_t)i * channels + ch] = (opus_int16)(std::max(-1.0f, std::min(1.0f, sample)) * 32767.0f);
+            }
+        }
+        return pcm;
+    }
+
+    struct CtlRunResult {
+        double totalUs = 0.0;   // Per frame, ctls plus encode
+        double ctlUs = 0.0;     // Per frame, ctls only
+        double savedPerFrame = 0.0;
+    };
+
+    // One pass over the signal doing what the encode hook does per frame
+    CtlRunResult RunCtlPass(OpusEncoder* enc, const std::vector<opus_int16>& pcm, bool caching) {
+        EncoderCtlCache ctl;
+        ctl.setCaching(caching);
+        opus_encoder_ctl(enc, 4028); // OPUS_RESET_STATE
+
+        unsigned char packet[BENCH_MAX_PACKET];
+        double ctlUs = 0.0;
+        double start = NowUs();
+        for (int f = 0; f < BENCH_FRAMES; f++) {
+            double ctlStart = NowUs();
+            ctl.beginFrame(enc);
+            int channels = ctl.getChannels(enc, 2);
+            ctl.getSampleRate(enc, 48000);
+            ctl.setBitrate(enc, 128000);
+            ctl.setForceChannels(enc, channels);
+            ctl.setDtx(enc, 0);
+            ctlUs += NowUs() - ctlStart;
+
+            opus_encode(enc, pcm.data() + (size_t)f * BENCH_FRAME_SIZE * BENCH_CHANNELS, BENCH_FRAME_SIZE, packet, BENCH_MAX_PACKET);
+        }
+
+        CtlRunResult result;
+        result.totalUs = (NowUs() - start) / BENCH_FRAMES;
+        result.ctlUs = ctlUs / BENCH_FRAMES;
+        result.savedPerFrame = (double)ctl.takeSavedCalls() / BENCH_FRAMES;
+        return result;
+    }
+
+    std::string RunCtlCacheBenchmark() {
+        int error = 0;
+        OpusEncoder* enc = opus_encoder_create(BENCH_SAMPLE_RATE, BENCH_CHANNELS, OPUS_APPLICATION_VOIP, &error);
+        if (!enc || error != OPUS_OK) {
+            return "Encoder ctl cache: could not create an encoder";
+        }
+
+        std::vector<opus_int16> pcm = MakeSpeechLikeSignal(BENCH_FRAMES * BENCH_FRAME_SIZE, BENCH_CHANNELS, BENCH_SAMPLE_RATE);
+
+        // Best of a few alternating rounds, so both variants see the same cache and clock state
+        CtlRunResult uncached, cached;
+        for (int round = 0; round < BENCH_ROUNDS; round++) {
+            CtlRunResult a = RunCtlPass(enc, pcm, false);
+            CtlRunResult b = RunCtlPass(enc, pcm, true);
+            if (round == 0 || a.totalUs < uncached.totalUs) uncached = a;
+            if (round == 0 || b.totalUs < cached.totalUs) cached = b;
+        }
+        opus_encoder_destroy(enc);
+
+        char text[512];
+        snprintf(text, sizeof(text),
+            "Encoder ctl cache (48 kHz stereo, 20 ms, %d frames)\n"
+            "Without cache: %.1f us/frame (ctl %.2f us)\n"
+            "With cache: %.1f us/frame (ctl %.2f us)\n"
+            "Saved: %.1f ctl calls/frame, %.1f%% of frame time",
+            BENCH_FRAMES,
+            uncached.totalUs, uncached.ctlUs,
+            cached.totalUs, cached.ctlUs,
+            cached.savedPerFrame,
+            uncached.totalUs > 0.0 ? 100.0 * (uncached.totalUs - cached.totalUs) / uncached.totalUs : 0.0);
+        return text;
+    }
+
+    constexpr int FEC_BITRATE = 24000;        // Mono voice, low enough for SILK where FEC lives
+    constexpr int FEC_FRAMES = 1000;          // 20 s per run
+    constexpr unsigned int FEC_SEED = 0xC0FFEEu;
+
+    struct EncodedStream {
+        std::vector<std::vector<unsigned char>> packets;
+        double kbps = 0.0;
+        int lookahead = 0;
+    };
+
+    EncodedStream EncodeMono(const std::vector<opus_int16>& pcm, bool fec, int lossPercent) {
+        EncodedStream stream;
+        int error = 0;
+        OpusEncoder* enc = opus_encoder_create(BENCH_SAMPLE_RATE, 1, OPUS_APPLICATION_VOIP, &error);
+        if (!enc || error != OPUS_OK) {
+            return stream;
+        }
+        opus_encoder_ctl(enc, OPUS_SET_BITRATE(FEC_BITRATE));
+        opus_encoder_ctl(enc, OPUS_SET_INBAND_FEC(fec ? 1 : 0));
+        opus_encoder_ctl(enc, OPUS_SET_PACKET_LOSS_PERC(lossPercent));
+        opus_int32 lookahead = 0;
+        opus_encoder_ctl(enc, OPUS_GET_LOOKAHEAD(&lookahead));
+        stream.lookahead = (int)lookahead;
+
+        unsigned char packet[BENCH_MAX_PACKET];
+        size_t bytes = 0;
+        for (int f = 0; f < FEC_FRAMES; f++) {
+            int len = opus_encode(enc, pcm.data() + (size_t)f * BENCH_FRAME_SIZE, BENCH_FRAME_SIZE, packet, BENCH_MAX_PACKET);
+            stream.packets.emplace_back(packet, packet + std::max(0, len));
+            bytes += std::max(0, len);
+        }
+        opus_encoder_destroy(enc);
+
+        stream.kbps = bytes * 8.0 / (FEC_FRAMES * BENCH_FRAME_SIZE / (double)BENCH_SAMPLE_RATE) / 1000.0;
+        return stream;
+    }
+
+    // Receiver with one packet of lookahead: a lost packet is rebuilt from the next
+    // one's FEC data when that arrived on time, otherwise it's concealed (PLC). A
+    // late packet still makes its own playout but comes too late to serve as FEC.
+    std::vector<float> DecodeWithLoss(const EncodedStream& stream, const std::vector<PacketFate>& fates, int& recovered) {
+        std::vector<float> out((size_t)FEC_FRAMES * BENCH_FRAME_SIZE, 0.0f);
+        recovered = 0;
+        int error = 0;
+        OpusDecoder* dec = opus_decoder_create(BENCH_SAMPLE_RATE, 1, &error);
+        if (!dec || error != OPUS_OK) {
+            return out;
+        }
+
+        for (int f = 0; f < FEC_FRAMES; f++) {
+            float* frame = out.data() + (size_t)f * BENCH_FRAME_SIZE;
+            const std::vector<unsigned char>& packet = stream.packets[f];
+            if (!fates[f].lost && !packet.empty()) {
+                opus_decode_float(dec, packet.data(), (opus_int32)packet.size(), frame, BENCH_FRAME_SIZE, 0);
+                continue;
+            }
+
+            bool nextOnTime = f + 1 < FEC_FRAMES && !fates[f + 1].lost && !fates[f + 1].late && !stream.packets[f + 1].empty();
+            if (nextOnTime) {
+                const std::vector<unsigned char>& next = stream.packets[f + 1];
+                opus_decode_float(dec, next.data(), (opus_int32)next.size(), frame, BENCH_FRAME_SIZE, 1);
+                recovered++;
+            }
+            else {
+                opus_decode_float(dec, nullptr, 0, frame, BENCH_FRAME_SIZE, 0);
+            }
+        }
+        opus_decoder_destroy(dec);
+        return out;
+    }
+
+    // Mean per-segment SNR over 20 ms segments with signal in them, each clamped to
+    // [-10, 35] dB so silent or perfect segments don't dominate. The decoded signal
+    // runs `delay` frames behind the reference, both are interleaved.
+    double SegmentalSnr(const float* reference, size_t referenceLength, const float* decoded, size_t decodedLength,
+        int delay, int channels) {
+        const size_t segment = (size_t)BENCH_FRAME_SIZE * channels;
+        const size_t offset = (size_t)delay * channels;
+        double total = 0.0;
+        int segments = 0;
+        for (size_t start = 0; start + segment + offset <= decodedLength && start + segment <= referenceLength; start += segment) {
+            double signal = 0.0, noise = 0.0;
+            for (size_t i = 0; i < segment; i++) {
+                double ref = reference[start + i];
+                double err = ref - decoded[start + i + offset];
+                signal += ref * ref;
+                noise += err * err;
+            }
+            // Skip segments below about -50 dBFS
+            if (signal < segment * 1e-5) continue;
+
+            double snr = 10.0 * log10(signal / std::max(noise, 1e-12));
+            total += std::max(-10.0, std::min(35.0, snr));
+            segments++;
+        }
+        return segments ? total / segments : 0.0;
+    }
+
+    double SegmentalSnr(const std::vector<opus_int16>& reference, const std::vector<float>& decoded, int delay) {
+        std::vector<float> referenceFloat(reference.size());
+        for (size_t i = 0; i < reference.size(); i++) {
+            referenceFloat[i] = reference[i] / 32768.0f;
+        }
+        return SegmentalSnr(referenceFloat.data(), referenceFloat.size(), decoded.data(), decoded.size(), delay, 1);
+    }
+
+    std::string RunFecBenchmark() {
+        std::vector<opus_int16> pcm = MakeSpeechLikeSignal(FEC_FRAMES * BENCH_FRAME_SIZE, 1, BENCH_SAMPLE_RATE);
+        std::vector<PacketFate> noLoss(FEC_FRAMES);
+
+        EncodedStream plain = EncodeMono(pcm, false, 0);
+        if (plain.packets.empty()) {
+            return "FEC / packet loss: could not create an encoder";
+        }
+        int unused = 0;
+        double plainClean = SegmentalSnr(pcm, DecodeWithLoss(plain, noLoss, unused), plain.lookahead);
+
+        char line[256];
+        snprintf(line, sizeof(line),
+            "FEC / packet loss (48 kHz mono, %d kbps, 20 ms, %d frames)\n"
+            "No FEC: %.1f kbps, clean segSNR %.1f dB\n",
+            FEC_BITRATE / 1000, FEC_FRAMES, plain.kbps, plainClean);
+        std::string text = line;
+
+        for (int m = 0; m < LOSS_MODEL_COUNT; m++) {
+            const GilbertElliottModel& model = LOSS_MODELS[m];
+
+            // Same losses for both encodings
+            PacketLossSimulator simulator;
+            simulator.configure(model, FEC_SEED + m);
+            std::vector<PacketFate> fates(FEC_FRAMES);
+            int lost = 0;
+            for (PacketFate& fate : fates) {
+                fate = simulator.next();
+                lost += fate.lost;
+            }
+
+            // FEC tuned to the model's loss rate, as OPUS_SET_PACKET_LOSS_PERC would be in a call
+            int lossPercent = (int)(model.expectedLoss() * 100.0f + 0.5f);
+            EncodedStream fec = EncodeMono(pcm, true, lossPercent);
+            if (fec.packets.empty()) {
+                continue;
+            }
+
+            int recoveredFec = 0;
+            double fecClean = SegmentalSnr(pcm, DecodeWithLoss(fec, noLoss, unused), fec.lookahead);
+            double plainLossy = SegmentalSnr(pcm, DecodeWithLoss(plain, fates, unused), plain.lookahead);
+            double fecLossy = SegmentalSnr(pcm, DecodeWithLoss(fec, fates, recoveredFec), fec.lookahead);
+
+            snprintf(line, sizeof(line),
+                "%s (%.1f%% lost): FEC %.1f kbps (%+.1f%%), clean %.1f dB, lossy %.1f -> %.1f dB, %d rebuilt\n",
+                model.name, 100.0 * lost / FEC_FRAMES,
+                fec.kbps, plain.kbps > 0.0 ? 100.0 * (fec.kbps - plain.kbps) / plain.kbps : 0.0,
+                fecClean, plainLossy, fecLossy, recoveredFec);
+            text += line;
+        }
+        text.pop_back(); // Trailing newline
+        return text;
+    }
+
+    constexpr int FRAME_BITRATES[] = { 32000, 128000 };
+    constexpr int PACKET_OVERHEAD_BYTES = 60;  // IPv4 + UDP + RTP + transport encryption, per packet
+
+    struct FrameDurationCase {
+        const char* name;
+        int frameMs;    // Frame size passed to opus_encode
+        int packMs;     // Packet duration after FramePacker, 0 for one packet per call
+    };
+
+    const FrameDurationCase FRAME_CASES[] = {
+        { "10 ms",        10, 0  },
+        { "20 ms",        20, 0  },
+        { "40 ms",        40, 0  },
+        { "60 ms",        60, 0  },
+        { "20 ms -> 40",  20, 40 },
+        { "20 ms -> 60",  20, 60 },
+    };
+
+    struct FrameRunResult {
+        double usPerSecond = 0.0;   // Encode plus packing time per second of audio
+        double payloadKbps = 0.0;
+        double wireKbps = 0.0;      // Payload plus per-packet overhead
+        double packetsPerSecond = 0.0;
+    };
+
+    FrameRunResult RunFramePass(OpusEncoder* enc, const std::vector<opus_int16>& pcm, const FrameDurationCase& test) {
+        FrameRunResult result;
+        int frameSize = BENCH_SAMPLE_RATE / 1000 * test.frameMs;
+        int frames = (int)(pcm.size() / BENCH_CHANNELS / frameSize);
+        int framesPerPacket = test.packMs ? test.packMs / test.frameMs : 1;
+        opus_encoder_ctl(enc, 4028); // OPUS_RESET_STATE
+
+        FramePacker packer;
+        unsigned char packet[BENCH_MAX_PACKET * 4];
+        size_t bytes = 0;
+        int packets = 0;
+        double start = NowUs();
+        for (int f = 0; f < frames; f++) {
+            int len = opus_encode(enc, pcm.data() + (size_t)f * frameSize * BENCH_CHANNELS, frameSize, packet, sizeof(packet));
+            len = packer.push(packet, len, framesPerPacket, sizeof(packet));
+            if (len > 0) {
+                bytes += len;
+                packets++;
+            }
+        }
+        double seconds = (double)frames * frameSize / BENCH_SAMPLE_RATE;
+
+        result.usPerSecond = (NowUs() - start) / seconds;
+        result.payloadKbps = bytes * 8.0 / seconds / 1000.0;
+        result.wireKbps = (bytes + (double)packets * PACKET_OVERHEAD_BYTES) * 8.0 / seconds / 1000.0;
+        result.packetsPerSecond = packets / seconds;
+        return result;
+    }
+
+    std::string RunFrameDurationBenchmark() {
+        int error = 0;
+        OpusEncoder* enc = opus_encoder_create(BENCH_SAMPLE_RATE, BENCH_CHANNELS, OPUS_APPLICATION_AUDIO, &error);
+        if (!enc || error != OPUS_OK) {
+            return "Frame duration: could not create an encoder";
+        }
+
+        std::vector<opus_int16> pcm = MakeSpeechLikeSignal(BENCH_FRAMES * BENCH_FRAME_SIZE, BENCH_CHANNELS, BENCH_SAMPLE_RATE);
+
+        char line[256];
+        snprintf(line, sizeof(line),
+            "Frame duration (48 kHz stereo, %d s, %d bytes overhead/packet)\n",
+            BENCH_FRAMES * BENCH_FRAME_SIZE / BENCH_SAMPLE_RATE, PACKET_OVERHEAD_BYTES);
+        std::string text = line;
+
+        for (int bitrate : FRAME_BITRATES) {
+            opus_encoder_ctl(enc, OPUS_SET_BITRATE(bitrate));
+            snprintf(line, sizeof(line), "%d kbps:\n", bitrate / 1000);
+            text += line;
+
+            for (const FrameDurationCase& test : FRAME_CASES) {
+                FrameRunResult best;
+                for (int round = 0; round < BENCH_ROUNDS; round++) {
+                    FrameRunResult run = RunFramePass(enc, pcm, test);
+                    if (round == 0 || run.usPerSecond < best.usPerSecond) best = run;
+                }
+                // Packing holds frames back, native long frames wait for the whole frame
+                int latencyMs = test.packMs ? test.packMs - test.frameMs : test.frameMs - 20;
+                snprintf(line, sizeof(line),
+                    "  %-12s %6.0f us/s, %.0f pkt/s, %.1f kbps payload, %.1f kbps wire, %+d ms\n",
+                    test.name, best.usPerSecond, best.packetsPerSecond, best.payloadKbps, best.wireKbps, latencyMs);
+                text += line;
+            }
+        }
+        opus_encoder_destroy(enc);
+
+        text.pop_back(); // Trailing newline
+        return text;
+    }
+
+    constexpr int MATRIX_FRAMES = 250;        // 5 s per clip, at 20 ms
+    constexpr int MATRIX_BITRATES[] = { 16000, 24000, 32000, 64000, 128000, 256000, 510000 };
+    constexpr int MATRIX_FRAME_MS[] = { 10, 20, 40, 60 };
+    constexpr int MATRIX_COMPLEXITIES = 11;   // 0 to 10
+    constexpr int MATRIX_REPORT_COMPLEXITIES[] = { 0, 5, 10 };
+    constexpr int CORPUS_COUNT = 2;
+    const char* const CORPUS_NAMES[CORPUS_COUNT] = { "speech", "music" };
+    const char* const MATRIX_CSV_PATH = "benchmark_matrix.csv";
+
+    constexpr int BITRATE_COUNT = sizeof(MATRIX_BITRATES) / sizeof(MATRIX_BITRATES[0]);
+    constexpr int FRAME_MS_COUNT = sizeof(MATRIX_FRAME_MS) / sizeof(MATRIX_FRAME_MS[0]);
+    constexpr int PRESET_COUNT = (int)EffectPreset::Count;
+
+    // Music stand-in: a chord change every half second over a bass line, with a
+    // decaying hi-hat every eighth note, the chord panned a little left and the bass
+    // a little right. Deterministic like the speech signal.
+    std::vector<opus_int16> MakeMusicLikeSignal(int frames, int channels, int sampleRate) {
+        static const float chords[4][3] = {
+            { 261.6f, 329.6f, 392.0f },
+            { 220.0f, 261.6f, 329.6f },
+            { 174.6f, 220.0f, 261.6f },
+            { 196.0f, 246.9f, 293.7f },
+        };
+        std::vector<opus_int16> pcm((size_t)frames * channels);
+        unsigned int noise = 0x9E3779B9u;
+        for (int i = 0; i < frames; i++) {
+            float t = (float)i / sampleRate;
+            const float* chord = chords[(int)(t * 2.0f) % 4];
+
+            float tones = 0.0f;
+            for (int n = 0; n < 3; n++) {
+                for (int h = 1; h <= 6; h++) {
+                    tones += sinf(2.0f * 3.14159265f * chord[n] * h * t) / (h * h);
+                }
+            }
+            float bass = sinf(2.0f * 3.14159265f * chord[0] * 0.25f * t);
+
+            noise = noise * 1664525u + 1013904223u;
+            float hatPhase = fmodf(t, 0.125f);
+            float hat = ((int)(noise >> 16) - 32768) / 32768.0f * expf(-hatPhase * 60.0f);
+
+            for (int ch = 0; ch < channels; ch++) {
+                float chordPan = ch == 0 ? 1.0f : 0.7f;
+                float bassPan = ch == 0 ? 0.7f : 1.0f;
+                float sample = tones * chordPan * 0.08f + bass * bassPan * 0.2f + hat * 0.08f;
+                pcm[(size_t)i * channels + ch] = (opus_int16)(std::max(-1.0f, std::min(1.0f, sample)) * 32767.0f);
+            }
+        }
+        return pcm;
+    }
+
+    // Run fn(0) .. fn(count - 1) on every core
+    template <typename Fn>
+    void RunParallel(int count, Fn fn) {
+        int threadCount = (int)std::max(1u, std::thread::hardware_concurrency());
+        std::atomic<int> next{ 0 };
+        std::vector<std::thread> threads;
+        for (int t = 0; t < std::min(threadCount, count); t++) {
+            threads.emplace_back([&] {
+                for (int i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                    fn(i);
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    struct MatrixPoint {
+        int corpus, preset, frame, bitrate, complexity;
+        double effectsUs = 0.0;   // Per frame
+        double encodeUs = 0.0;    // Per frame
+        double bytesPerSecond = 0.0;
+        double snr = 0.0;         // Decoded against the processed clip
+    };
+
+    // Run a corpus clip through one preset's effect chain in place, returns us per frame
+    double ProcessClip(std::vector<float>& pcm, EffectPreset preset, int frameSize) {
+        PipelineSession* session = CreatePipelineSession(preset, BENCH_SAMPLE_RATE, BENCH_CHANNELS);
+        if (!session) {
+            return 0.0;
+        }
+        int frames = (int)(pcm.size() / BENCH_CHANNELS / frameSize);
+        double effectsUs = 0.0;
+        for (int f = 0; f < frames; f++) {
+            double start = NowUs();
+            ProcessPipelineFrame(session, pcm.data() + (size_t)f * frameSize * BENCH_CHANNELS, frameSize);
+            effectsUs += NowUs() - start;
+        }
+        DestroyPipelineSession(session);
+        return frames ? effectsUs / frames : 0.0;
+    }
+
+    void RunMatrixPoint(const std::vector<float>& clip, MatrixPoint& point) {
+        int frameSize = BENCH_SAMPLE_RATE / 1000 * MATRIX_FRAME_MS[point.frame];
+        int frames = (int)(clip.size() / BENCH_CHANNELS / frameSize);
+        size_t length = (size_t)frames * frameSize * BENCH_CHANNELS;
+
+        int error = 0;
+        OpusEncoder* enc = opus_encoder_create(BENCH_SAMPLE_RATE, BENCH_CHANNELS, OPUS_APPLICATION_AUDIO, &error);
+        OpusDecoder* dec = opus_decoder_create(BENCH_SAMPLE_RATE, BENCH_CHANNELS, &error);
+        if (!enc || !dec || frames == 0) {
+            if (enc) opus_encoder_destroy(enc);
+            if (dec) opus_decoder_destroy(dec);
+            return;
+        }
+        opus_encoder_ctl(enc, OPUS_SET_BITRATE(point.bitrate));
+        opus_encoder_ctl(enc, OPUS_SET_COMPLEXITY(point.complexity));
+        opus_int32 lookahead = 0;
+        opus_encoder_ctl(enc, OPUS_GET_LOOKAHEAD(&lookahead));
+
+        std::vector<float> decoded(length, 0.0f);
+        unsigned char packet[BENCH_MAX_PACKET * 4];
+        size_t bytes = 0;
+        double encodeUs = 0.0;
+        for (int f = 0; f < frames; f++) {
+            size_t offset = (size_t)f * frameSize * BENCH_CHANNELS;
+            double start = NowUs();
+            int len = opus_encode_float(enc, clip.data() + offset, frameSize, packet, sizeof(packet));
+            encodeUs += NowUs() - start;
+            if (len <= 0) continue;
+
+            bytes += len;
+            opus_decode_float(dec, packet, len, decoded.data() + offset, frameSize, 0);
+        }
+        opus_encoder_destroy(enc);
+        opus_decoder_destroy(dec);
+
+        point.encodeUs = encodeUs / frames;
+        point.bytesPerSecond = bytes / ((double)frames * frameSize / BENCH_SAMPLE_RATE);
+        point.snr = SegmentalSnr(clip.data(), length, decoded.data(), decoded.size(), (int)lookahead, BENCH_CHANNELS);
+    }
+
+    std::string RunEffectMatrixBenchmark() {
+        double started = NowUs();
+        int totalFrames = MATRIX_FRAMES * BENCH_FRAME_SIZE;
+        std::vector<opus_int16> corpus[CORPUS_COUNT] = {
+            MakeSpeechLikeSignal(totalFrames, BENCH_CHANNELS, BENCH_SAMPLE_RATE),
+            MakeMusicLikeSignal(totalFrames, BENCH_CHANNELS, BENCH_SAMPLE_RATE),
+        };
+
+        // Effects only depend on corpus, preset and frame size: process each combination
+        // once, then sweep bitrate and complexity over it on every core. One clip lives
+        // at a time, which keeps memory at a few MB.
+        std::vector<MatrixPoint> points;
+        points.reserve((size_t)CORPUS_COUNT * PRESET_COUNT * FRAME_MS_COUNT * BITRATE_COUNT * MATRIX_COMPLEXITIES);
+        std::vector<float> clip(corpus[0].size());
+        for (int c = 0; c < CORPUS_COUNT; c++) {
+            for (int p = 0; p < PRESET_COUNT; p++) {
+                for (int f = 0; f < FRAME_MS_COUNT; f++) {
+                    for (size_t i = 0; i < clip.size(); i++) {
+                        clip[i] = corpus[c][i] / 32768.0f;
+                    }
+                    double effectsUs = ProcessClip(clip, (EffectPreset)p, BENCH_SAMPLE_RATE / 1000 * MATRIX_FRAME_MS[f]);
+
+                    size_t first = points.size();
+                    for (int b = 0; b < BITRATE_COUNT; b++) {
+                        for (int x = 0; x < MATRIX_COMPLEXITIES; x++) {
+                            MatrixPoint point = { c, p, f, MATRIX_BITRATES[b], x };
+                            point.effectsUs = effectsUs;
+                            points.push_back(point);
+                        }
+                    }
+                    RunParallel((int)(points.size() - first), [&](int index) {
+                        RunMatrixPoint(clip, points[first + index]);
+                    });
+                }
+            }
+        }
+
+        // Every point goes to the CSV, the report keeps a summary
+        std::ofstream csv(MATRIX_CSV_PATH);
+        if (csv.is_open()) {
+            csv << "corpus,preset,frame_ms,bitrate,complexity,effects_us_per_frame,encode_us_per_frame,bytes_per_second,seg_snr_db\n";
+            for (const MatrixPoint& point : points) {
+                char row[256];
+                snprintf(row, sizeof(row), "%s,%s,%d,%d,%d,%.2f,%.2f,%.0f,%.2f\n",
+                    CORPUS_NAMES[point.corpus], EFFECT_PRESET_NAMES[point.preset], MATRIX_FRAME_MS[point.frame],
+                    point.bitrate, point.complexity, point.effectsUs, point.encodeUs, point.bytesPerSecond, point.snr);
+                csv << row;
+            }
+        }
+
+        // Points are stored in sweep order
+        auto pointAt = [&](int corpusIndex, int preset, int frame, int bitrate, int complexity) -> const MatrixPoint& {
+            size_t index = (((size_t)(corpusIndex * PRESET_COUNT + preset) * FRAME_MS_COUNT + frame) * BITRATE_COUNT + bitrate) * MATRIX_COMPLEXITIES + complexity;
+            return points[index];
+        };
+
+        char line[256];
+        snprintf(line, sizeof(line),
+            "Effect matrix (%d points, %d s speech + music, 48 kHz stereo, %.1f s)\n"
+            "%s\n"
+            "Effects per 20 ms frame (speech / music):\n",
+            (int)points.size(), totalFrames / BENCH_SAMPLE_RATE, (NowUs() - started) / 1e6,
+            csv.is_open() ? "All points written to benchmark_matrix.csv" : "Could not write benchmark_matrix.csv");
+        std::string text = line;
+
+        const int frame20 = 1;
+        for (int p = 0; p < PRESET_COUNT; p++) {
+            snprintf(line, sizeof(line), "  %-8s %6.1f / %6.1f us\n", EFFECT_PRESET_NAMES[p],
+                pointAt(0, p, frame20, 0, 0).effectsUs, pointAt(1, p, frame20, 0, 0).effectsUs);
+            text += line;
+        }
+
+        // Encoder side with the current preset at 20 ms
+        for (int c = 0; c < CORPUS_COUNT; c++) {
+            snprintf(line, sizeof(line), "Encode, %s, Current, 20 ms (us/frame, segSNR) at complexity 0 / 5 / 10:\n", CORPUS_NAMES[c]);
+            text += line;
+            for (int b = 0; b < BITRATE_COUNT; b++) {
+                snprintf(line, sizeof(line), "  %3d kbps:", MATRIX_BITRATES[b] / 1000);
+                text += line;
+                for (int x : MATRIX_REPORT_COMPLEXITIES) {
+                    const MatrixPoint& point = pointAt(c, (int)EffectPreset::Current, frame20, b, x);
+                    snprintf(line, sizeof(line), "  %5.0f us %5.1f dB", point.encodeUs, point.snr);
+                    text += line;
+                }
+                text += "\n";
+            }
+        }
+        text.pop_back(); // Trailing newline
+        return text;
+    }
+
+    constexpr int MIX_TICKS = 500;            // 10 s of 20 ms ticks
+    constexpr int MIX_MEMBERS[] = { 8, 32, 64 };
+    constexpr int MIX_TALKERS[] = { 1, 4, 8 };
+    constexpr float MIX_QUIET_LEVEL = 0.0003f;  // About -70 dBFS, what a decoder puts out between words
+
+    struct MixRunResult {
+        double mixerUs = 0.0;   // Per tick, submit plus mix
+        double plainUs = 0.0;   // Per tick, every voice summed
+    };
+
+    // Voice k of the channel for a tick: talkers read the speech clip at their own
+    // offset, everyone else gets low-level noise
+    const float* MixVoiceFrame(const std::vector<float>& speech, const std::vector<float>& quiet, int k, int talkers, int tick) {
+        if (k >= talkers) {
+            return quiet.data();
+        }
+        int frame = (tick + k * 37) % MIX_TICKS;
+        return speech.data() + (size_t)frame * BENCH_FRAME_SIZE * BENCH_CHANNELS;
+    }
+
+    MixRunResult RunMixPass(StreamMixer& mixer, const std::vector<float>& speech, const std::vector<float>& quiet, int members, int talkers) {
+        MixRunResult result;
+        std::vector<float> bus((size_t)BENCH_FRAME_SIZE * BENCH_CHANNELS);
+
+        mixer.configure(BENCH_SAMPLE_RATE);
+        int ids[StreamMixer::MAX_STREAMS];
+        for (int k = 0; k < members; k++) {
+            ids[k] = mixer.addStream();
+            mixer.setGainPan(ids[k], 0.0f, (k % 5 - 2) * 0.4f);
+        }
+        double start = NowUs();
+        for (int tick = 0; tick < MIX_TICKS; tick++) {
+            for (int k = 0; k < members; k++) {
+                mixer.submit(ids[k], MixVoiceFrame(speech, quiet, k, talkers, tick), BENCH_FRAME_SIZE, BENCH_CHANNELS);
+            }
+            mixer.mix(bus.data(), BENCH_FRAME_SIZE);
+        }
+        result.mixerUs = (NowUs() - start) / MIX_TICKS;
+        for (int k = 0; k < members; k++) {
+            mixer.removeStream(ids[k]);
+        }
+
+        // What a mixer without voice tracking does: scalar sum of everyone, same limiter
+        PeakLimiter limiter;
+        TruePeakDetector sidechain;
+        limiter.configure(BENCH_SAMPLE_RATE, BENCH_CHANNELS, PeakLimiter::MIN_LOOKAHEAD_MS);
+        limiter.setSidechainLatency(TruePeakDetector::LATENCY);
+        sidechain.configure(BENCH_CHANNELS);
+        std::vector<float> peaks(BENCH_FRAME_SIZE);
+        start = NowUs();
+        for (int tick = 0; tick < MIX_TICKS; tick++) {
+            std::fill(bus.begin(), bus.end(), 0.0f);
+            for (int k = 0; k < members; k++) {
+                const float* voice = MixVoiceFrame(speech, quiet, k, talkers, tick);
+                float left = std::min(1.0f, 1.0f - (k % 5 - 2) * 0.4f);
+                float right = std::min(1.0f, 1.0f + (k % 5 - 2) * 0.4f);
+                for (int i = 0; i < BENCH_FRAME_SIZE; i++) {
+                    bus[i * 2] += voice[i * 2] * left;
+                    bus[i * 2 + 1] += voice[i * 2 + 1] * right;
+                }
+            }
+            sidechain.process(bus.data(), BENCH_FRAME_SIZE, peaks.data());
+            limiter.process(bus.data(), BENCH_FRAME_SIZE, peaks.data());
+        }
+        result.plainUs = (NowUs() - start) / MIX_TICKS;
+        return result;
+    }
+
+    std::string RunStreamMixBenchmark() {
+        // Decoded voices stand in as float frames, decoding isn't what's measured here
+        std::vector<opus_int16> pcm = MakeSpeechLikeSignal(MIX_TICKS * BENCH_FRAME_SIZE, BENCH_CHANNELS, BENCH_SAMPLE_RATE);
+        std::vector<float> speech(pcm.size());
+        for (size_t i = 0; i < pcm.size(); i++) {
+            speech[i] = pcm[i] / 32768.0f;
+        }
+        std::vector<float> quiet((size_t)BENCH_FRAME_SIZE * BENCH_CHANNELS);
+        unsigned int noise = 0x2545F491u;
+        for (float& sample : quiet) {
+            noise = noise * 1664525u + 1013904223u;
+            sample = ((int)(noise >> 16) - 32768) / 32768.0f * MIX_QUIET_LEVEL;
+        }
+
+        std::unique_ptr<StreamMixer> mixer(new (std::nothrow) StreamMixer());
+        if (!mixer) {
+            return "Incoming mix: out of memory";
+        }
+
+        char line[256];
+        snprintf(line, sizeof(line),
+            "Incoming mix (48 kHz stereo, 20 ms ticks, %d ticks, best of %d)\n"
+            "Voices, talking: mixer / plain sum (us per tick)\n",
+            MIX_TICKS, BENCH_ROUNDS);
+        std::string text = line;
+
+        for (int members : MIX_MEMBERS) {
+            for (int talkers : MIX_TALKERS) {
+                MixRunResult best;
+                for (int round = 0; round < BENCH_ROUNDS; round++) {
+                    MixRunResult run = RunMixPass(*mixer, speech, quiet, members, talkers);
+                    if (round == 0 || run.mixerUs < best.mixerUs) best.mixerUs = run.mixerUs;
+                    if (round == 0 || run.plainUs < best.plainUs) best.plainUs = run.plainUs;
+                }
+                snprintf(line, sizeof(line), "  %2d, %d: %6.1f / %6.1f us (%.1fx)\n", members, talkers,
+                    best.mixerUs, best.plainUs, best.mixerUs > 0.0 ? best.plainUs / best.mixerUs : 0.0);
+                text += line;
+            }
+        }
+        text.pop_back(); // Trailing newline
+        return text;
+    }
+
+    constexpr unsigned int JITTER_SEED = 0x5EED5EEDu;
+    constexpr int JITTER_FEC_LOSS_PERCENT = 10;  // FEC strength of the synthetic stream
+
+    struct JitterPolicy {
+        const char* name;
+        float quantile;         // 0 for a fixed buffer
+        float fixedDelayMs;
+    };
+
+    const JitterPolicy JITTER_POLICIES[] = {
+        { "Fixed 40 ms",   0.0f,  40.0f  },
+        { "Fixed 100 ms",  0.0f,  100.0f },
+        { "Adaptive 90%",  0.90f, 0.0f   },
+        { "Adaptive 95%",  0.95f, 0.0f   },
+        { "Adaptive 99%",  0.99f, 0.0f   },
+    };
+
+    struct PacketArrival {
+        double arrivalMs;
+        size_t index;
+    };
+
+    struct JitterRunResult {
+        double addedDelayMs = 0.0;  // Mean playout delay over the fastest packet's transit
+        int played = 0;
+        int fec = 0, plc = 0, stretch = 0;
+        int skipped = 0, late = 0, misaligned = 0;
+    };
+
+    // Send times follow the timestamps, arrivals add the model's delay; lost packets never arrive
+    std::vector<PacketArrival> MakeArrivals(const std::vector<ReplayPacket>& packets, const JitterModel& model, unsigned int seed) {
+        JitterSimulator jitter;
+        jitter.configure(model, seed);
+        PacketLossSimulator loss;
+        if (model.lossModel >= 0) {
+            loss.configure(LOSS_MODELS[model.lossModel], seed ^ 0xA5A5A5A5u);
+        }
+
+        std::vector<PacketArrival> arrivals;
+        arrivals.reserve(packets.size());
+        long long previous = packets.empty() ? 0 : packets[0].timestamp;
+        for (size_t i = 0; i < packets.size(); i++) {
+            float intervalMs = (packets[i].timestamp - previous) * 1000.0f / BENCH_SAMPLE_RATE;
+            previous = packets[i].timestamp;
+            float delayMs = jitter.next(intervalMs);
+            if (model.lossModel >= 0 && loss.next().lost) continue;
+            arrivals.push_back({ packets[i].timestamp * 1000.0 / BENCH_SAMPLE_RATE + delayMs, i });
+        }
+        std::stable_sort(arrivals.begin(), arrivals.end(), [](const PacketArrival& a, const PacketArrival& b) {
+            return a.arrivalMs < b.arrivalMs;
+        });
+        return arrivals;
+    }
+
+    // Play the whole stream through one jitter buffer on a clock that advances by what it plays
+    JitterRunResult RunJitterPass(JitterBuffer& buffer, const std::vector<ReplayPacket>& packets, const std::vector<PacketArrival>& arrivals,
+        int channels, int frameSize, const JitterPolicy& policy) {
+        JitterRunResult result;
+        int error = 0;
+        OpusDecoder* dec = opus_decoder_create(BENCH_SAMPLE_RATE, channels, &error);
+        if (!dec || error != OPUS_OK || arrivals.empty()) {
+            if (dec) opus_decoder_destroy(dec);
+            return result;
+        }
+        buffer.configure(BENCH_SAMPLE_RATE, frameSize, policy.quantile, policy.fixedDelayMs);
+
+        const ReplayPacket& last = packets.back();
+        int lastSamples = opus_packet_get_nb_samples(last.data.data(), (opus_int32)last.data.size(), BENCH_SAMPLE_RATE);
+        long long endTimestamp = last.timestamp + std::max(lastSamples, 0);
+
+        std::vector<opus_int16> pcm((size_t)5760 * channels);
+        double now = arrivals.front().arrivalMs;
+        size_t next = 0;
+        for (size_t guard = 0; guard < packets.size() * 8; guard++) {
+            while (next < arrivals.size() && arrivals[next].arrivalMs <= now) {
+                const ReplayPacket& packet = packets[arrivals[next].index];
+                buffer.insert(packet.data.data(), (int)packet.data.size(), packet.timestamp, arrivals[next].arrivalMs);
+                next++;
+            }
+            if (buffer.hasStarted() && buffer.getPlayoutTimestamp() >= endTimestamp) break;
+
+            JitterBuffer::FrameSource source;
+            int samples = buffer.pull(dec, pcm.data(), channels, now, source);
+            now += samples * 1000.0 / BENCH_SAMPLE_RATE;
+        }
+        opus_decoder_destroy(dec);
+
+        const JitterBuffer::Stats& stats = buffer.getStats();
+        result.fec = stats.played[(int)JitterBuffer::FrameSource::Fec];
+        result.plc = stats.played[(int)JitterBuffer::FrameSource::Plc];
+        result.stretch = stats.played[(int)JitterBuffer::FrameSource::Stretch];
+        result.played = stats.played[(int)JitterBuffer::FrameSource::Packet] + result.fec + result.plc + result.stretch;
+        result.skipped = stats.skipped;
+        result.late = stats.late;
+        result.misaligned = stats.misaligned;
+        if (result.played > 0) {
+            result.addedDelayMs = stats.delaySumMs / result.played - buffer.getMinTransitMs();
+        }
+        return result;
+    }
+
+    std::string RunJitterBenchmark(const std::string& replayPath) {
+        // The last recording when there is one, else a synthetic stream with FEC
+        std::vector<ReplayPacket> packets;
+        int channels = 0;
+        std::string source;
+        if (!replayPath.empty() && ReadOggOpusFile(replayPath, packets, channels) && channels <= 2) {
+            source = replayPath;
+        }
+        else {
+            std::vector<opus_int16> pcm = MakeSpeechLikeSignal(FEC_FRAMES * BENCH_FRAME_SIZE, 1, BENCH_SAMPLE_RATE);
+            EncodedStream stream = EncodeMono(pcm, true, JITTER_FEC_LOSS_PERCENT);
+            if (stream.packets.empty()) {
+                return "Jitter buffer: could not create an encoder";
+            }
+            packets.clear();
+            for (int f = 0; f < FEC_FRAMES; f++) {
+                if (stream.packets[f].empty()) continue;
+                packets.push_back({ (long long)f * BENCH_FRAME_SIZE, stream.packets[f] });
+            }
+            channels = 1;
+            source = "synthetic speech, in-band FEC";
+        }
+
+        // Nominal frame: the first packet's duration
+        int frameSize = opus_packet_get_nb_samples(packets[0].data.data(), (opus_int32)packets[0].data.size(), BENCH_SAMPLE_RATE);
+        if (frameSize <= 0) {
+            frameSize = BENCH_FRAME_SIZE;
+        }
+
+        std::unique_ptr<JitterBuffer> buffer(new (std::nothrow) JitterBuffer());
+        if (!buffer) {
+            return "Jitter buffer: out of memory";
+        }
+
+        char line[256];
+        snprintf(line, sizeof(line),
+            "Jitter buffer (%s, %d packets, %d ms frames)\n"
+            "Delay over the fastest packet, concealed frames (FEC / PLC / stretch), skipped, late and misaligned packets\n",
+            source.c_str(), (int)packets.size(), frameSize * 1000 / BENCH_SAMPLE_RATE);
+        std::string text = line;
+
+        for (int m = 0; m < JITTER_MODEL_COUNT; m++) {
+            const JitterModel& model = JITTER_MODELS[m];
+            std::vector<PacketArrival> arrivals = MakeArrivals(packets, model, JITTER_SEED + m);
+            snprintf(line, sizeof(line), "%s (%.1f%% lost):\n", model.name,
+                packets.empty() ? 0.0 : 100.0 * (packets.size() - arrivals.size()) / packets.size());
+            text += line;
+
+            for (const JitterPolicy& policy : JITTER_POLICIES) {
+                JitterRunResult run = RunJitterPass(*buffer, packets, arrivals, channels, frameSize, policy);
+                double played = std::max(run.played, 1);
+                snprintf(line, sizeof(line), "  %-13s %6.1f ms  %5.1f%% (%.1f / %.1f / %.1f)  %d skipped, %d late, %d misaligned\n",
+                    policy.name, run.addedDelayMs,
+                    100.0 * (run.fec + run.plc + run.stretch) / played,
+                    100.0 * run.fec / played, 100.0 * run.plc / played, 100.0 * run.stretch / played,
+                    run.skipped, run.late, run.misaligned);
+                text += line;
+            }
+        }
+        text.pop_back(); // Trailing newline
+        return text;
+    }
+}
+
+bool BenchmarkRunner::start(BenchmarkId id, const std::string& inputPath) {
+    bool expected = false;
+    if (!running.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+        return false;
+    }
+
+    std::thread([this, id, inputPath] {
+        std::string result;
+        switch (id) {
+        case BenchmarkId::CtlCache:
+            result = RunCtlCacheBenchmark();
+            break;
+        case BenchmarkId::FecLoss:
+            result = RunFecBenchmark();
+            break;
+        case BenchmarkId::FrameDuration:
+            result = RunFrameDurationBenchmark();
+            break;
+        case BenchmarkId::EffectMatrix:
+            result = RunEffectMatrixBenchmark();
+            break;
+        case BenchmarkId::StreamMix:
+            result = RunStreamMixBenchmark();
+            break;
+        case BenchmarkId::JitterBuffer:
+            result = RunJitterBenchmark(inputPath);
+            break;
+        default:
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(reportMutex);
+            report = result;
+        }
+        running.store(false, std::memory_order_release);
+    }).detach();
+    return true;
+}
+
+std::string BenchmarkRunner::getReport() {
+    std::lock_guard<std::mutex> lock(reportMutex);
+    return report;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+
+// Benchmarks, in the order shown on the Infos tab
+enum class BenchmarkId : int {
+    CtlCache = 0,   // Encode time with and without the encoder ctl cache
+    FecLoss,        // In-band FEC on and off through simulated packet loss
+    FrameDuration,  // CPU and bytes per second for native and packed frame durations
+    EffectMatrix,   // Bitrate x complexity x frame size x effect preset sweep of the send pipeline
+    StreamMix,      // Incoming voice mixer against a plain sum, by channel size and talkers
+    JitterBuffer,   // Playout delay against concealment for fixed and adaptive jitter buffers
+    Count
+};
+
+// Effect chain presets the matrix benchmark sweeps
+enum class EffectPreset : int {
+    Bypass = 0,     // Every optional stage off, unity gain
+    Current,        // The settings on the Encoder tab
+    Voice,          // Bypass plus compressor and auto gain
+    Full,           // Current plus every optional stage
+    Count
+};
+extern const char* const EFFECT_PRESET_NAMES[(int)EffectPreset::Count];
+
+// The send effect chain for offline runs, implemented in overlay.cpp where the chain
+// lives. A session has its own DSP state and is never seen by the live streams, so
+// sessions can run on several threads at once.
+struct PipelineSession;
+PipelineSession* CreatePipelineSession(EffectPreset preset, int sampleRate, int channels);
+void DestroyPipelineSession(PipelineSession* session);
+void ProcessPipelineFrame(PipelineSession* session, float* pcm, int frameSize);
+
+// BenchmarkRunner - offline measurements started from the Infos tab.
+//
+// Each benchmark builds its own encoder and synthetic speech-like input (or reads a
+// recording), so the live streams are never touched. One benchmark runs at a time on a background
+// thread; when it's done its text report replaces the previous one.
+class BenchmarkRunner {
+public:
+    static const char* const NAMES[(int)BenchmarkId::Count];
+
+    BenchmarkRunner() = default;
+    BenchmarkRunner(const BenchmarkRunner&) = delete;
+    BenchmarkRunner& operator=(const BenchmarkRunner&) = delete;
+
+    // Start a benchmark, false if one is already running. inputPath is an Ogg Opus
+    // recording the jitter buffer benchmark replays instead of its synthetic stream.
+    bool start(BenchmarkId id, const std::string& inputPath = std::string());
+
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+
+    // Report of the last finished benchmark, empty before the first one
+    std::string getReport();
+
+private:
+    std::atomic<bool> running{ false };
+    std::mutex reportMutex;
+    std::string report;
+};
@@ -0,0 +1,138 @@
+#include "channelLayout.hpp"
+#include <emmintrin.h>
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For lrintf
+
+namespace {
+    void AddPair(ChannelLayout& layout, int left, int right) {
+        ChannelGroup& group = layout.groups[layout.groupCount++];
+        group.count = 2;
+        group.channels[0] = left;
+        group.channels[1] = right;
+    }
+
+    void AddMono(ChannelLayout& layout, int channel, bool lfe = false) {
+        ChannelGroup& group = layout.groups[layout.groupCount++];
+        group.count = 1;
+        group.channels[0] = channel;
+        group.lfe = lfe;
+    }
+}
+
+ChannelLayout MakeChannelLayout(int channels) {
+    ChannelLayout layout;
+    if (channels <= 0 || channels > ChannelLayout::MAX_CHANNELS) {
+        return layout;
+    }
+    layout.channels = channels;
+
+    // Vorbis channel order, see RFC 7845 section 5.1.1.2
+    switch (channels) {
+    case 3: // L, C, R
+        AddPair(layout, 0, 2);
+        AddMono(layout, 1);
+        break;
+    case 5: // FL, C, FR, RL, RR
+        AddPair(layout, 0, 2);
+        AddMono(layout, 1);
+        AddPair(layout, 3, 4);
+        break;
+    case 6: // FL, C, FR, RL, RR, LFE
+        AddPair(layout, 0, 2);
+        AddMono(layout, 1);
+        AddPair(layout, 3, 4);
+        AddMono(layout, 5, true);
+        break;
+    case 7: // FL, C, FR, SL, SR, RC, LFE
+        AddPair(layout, 0, 2);
+        AddMono(layout, 1);
+        AddPair(layout, 3, 4);
+        AddMono(layout, 5);
+        AddMono(layout, 6, true);
+        break;
+    case 8: // FL, C, FR, SL, SR, RL, RR, LFE
+        AddPair(layout, 0, 2);
+        AddMono(layout, 1);
+        AddPair(layout, 3, 4);
+        AddPair(layout, 5, 6);
+        AddMono(layout, 7, true);
+        break;
+    default: // Mono, stereo, quad: consecutive pairs
+        for (int ch = 0; ch + 1 < channels; ch += 2) {
+            AddPair(layout, ch, ch + 1);
+        }
+        if (channels & 1) {
+            AddMono(layout, channels - 1);
+        }
+        break;
+    }
+    return layout;
+}
+
+void GatherChannelGroup(const float* frame, int frameChannels, const ChannelGroup& group, float* block, int frames) {
+    const float* src = frame + group.channels[0];
+    if (group.count == 1) {
+        for (int i = 0; i < frames; i++) {
+            block[i] = src[i * frameChannels];
+        }
+        return;
+    }
+
+    int offset = group.channels[1] - group.channels[0];
+    for (int i = 0; i < frames; i++) {
+        block[i * 2] = src[i * frameChannels];
+        block[i * 2 + 1] = src[i * frameChannels + offset];
+    }
+}
+
+void ScatterChannelGroup(const float* block, const ChannelGroup& group, float* frame, int frameChannels, int frames) {
+    float* dst = frame + group.channels[0];
+    if (group.count == 1) {
+        for (int i = 0; i < frames; i++) {
+            dst[i * frameChannels] = block[i];
+        }
+        return;
+    }
+
+    int offset = group.channels[1] - group.channels[0];
+    for (int i = 0; i < frames; i++) {
+        dst[i * frameChannels] = block[i * 2];
+        dst[i * frameChannels + offset] = block[i * 2 + 1];
+    }
+}
+
+void ConvertInt16ToFloat(const opus_int16* in, float* out, int count) {
+    const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        // Sign-extend to 32 bits: put each sample in the high half, then shift it back down
+        __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+    }
+    for (; i < count; i++) {
+        out[i] = in[i] / 32768.0f;
+    }
+}
+
+void ConvertFloatToInt16(const float* in, opus_int16* out, int count) {
+    // Clamp in float first, out-of-range conversions would wrap to INT_MIN
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 maxValue = _mm_set1_ps(32767.0f);
+    const __m128 minValue = _mm_set1_ps(-32768.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 low = _mm_mul_ps(_mm_loadu_ps(in + i), scale);
+        __m128 high = _mm_mul_ps(_mm_loadu_ps(in + i + 4), scale);
+        low = _mm_max_ps(_mm_min_ps(low, maxValue), minValue);
+        high = _mm_max_ps(_mm_min_ps(high, maxValue), minValue);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+    for (; i < count; i++) {
+        float sample = std::max(-32768.0f, std::min(in[i] * 32768.0f, 32767.0f));
+        out[i] = (opus_int16)lrintf(sample);
+    }
+}
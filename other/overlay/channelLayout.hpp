@@ -0,0 +1,38 @@
+#pragma once
+#include "libraries/opus/include/opus.h"
+
+// One group of a multichannel frame: a stereo pair or a single channel
+struct ChannelGroup {
+    int count = 0;          // 1 or 2
+    int channels[2] = {};   // Indices in the interleaved frame
+    bool lfe = false;       // Low-frequency effects channel, left untouched by the effects
+};
+
+// ChannelLayout - splits a multichannel frame into groups the effect chain can run on.
+//
+// The effect stages are written for mono or stereo, so surround audio is processed
+// per group, each group with its own chain state: front, side and rear pairs keep
+// their stereo image, the center is mono and the LFE is skipped. Layouts follow
+// Opus mapping family 1 (Vorbis channel order) up to 7.1; anything else is split
+// into consecutive pairs.
+struct ChannelLayout {
+    static constexpr int MAX_CHANNELS = 8;
+    static constexpr int MAX_GROUPS = 5;    // 7.1: front, center, side, rear, LFE
+
+    int channels = 0;
+    int groupCount = 0;
+    ChannelGroup groups[MAX_GROUPS];
+};
+
+// Layout for a frame with this many channels (1 - MAX_CHANNELS), groupCount 0 otherwise
+ChannelLayout MakeChannelLayout(int channels);
+
+// Copy one group out of an interleaved frame into a compact interleaved block, and back
+void GatherChannelGroup(const float* frame, int frameChannels, const ChannelGroup& group, float* block, int frames);
+void ScatterChannelGroup(const float* block, const ChannelGroup& group, float* frame, int frameChannels, int frames);
+
+// int16 to float in [-1, 1), SSE
+void ConvertInt16ToFloat(const opus_int16* in, float* out, int count);
+
+// float to int16 with rounding and saturation, SSE
+void ConvertFloatToInt16(const float* in, opus_int16* out, int count);
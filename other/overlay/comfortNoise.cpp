@@ -0,0 +1,214 @@
+#include "comfortNoise.hpp"
+#include <emmintrin.h>
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For sqrtf, log10f, powf
+#include <cstring>   // For memset
+
+namespace {
+    constexpr float AUTOCORRELATION_SMOOTHING = 0.1f;  // Share of a new noise frame in the model
+    constexpr float FLOOR_FALL = 0.5f;                 // Share of a quieter frame taken into the floor at once
+    constexpr double WHITE_NOISE_CORRECTION = 1.0001;  // -40 dB of white noise keeps Levinson well conditioned
+    constexpr float WHITE_VARIANCE = 1.0f / 3.0f;      // Uniform noise in [-1, 1)
+
+    float DbToEnergy(float db) {
+        return powf(10.0f, db / 10.0f);
+    }
+}
+
+ComfortNoise::ComfortNoise() {
+    // Fixed odd seeds, the lanes only need to differ from each other
+    lanes[0] = 0x9E3779B9u;
+    lanes[1] = 0x7F4A7C15u;
+    lanes[2] = 0x85EBCA6Bu;
+    lanes[3] = 0xC2B2AE35u;
+    reset();
+}
+
+void ComfortNoise::configure(int newSampleRate) {
+    if (newSampleRate == sampleRate) {
+        return;
+    }
+    sampleRate = newSampleRate;
+    reset();
+}
+
+void ComfortNoise::reset() {
+    floorEnergy = -1.0f;
+    memset(autocorrelation, 0, sizeof(autocorrelation));
+    haveModel = false;
+    modelDirty = false;
+    memset(lpc, 0, sizeof(lpc));
+    shapeGain = 1.0f;
+    memset(history, 0, sizeof(history));
+}
+
+float ComfortNoise::getFloorDb() const {
+    return floorEnergy > 1e-12f ? 10.0f * log10f(floorEnergy) : -120.0f;
+}
+
+void ComfortNoise::analyze(const float* frame, int frames, int channels) {
+    if (!frame || frames <= ORDER || channels <= 0 || sampleRate <= 0) {
+        return;
+    }
+
+    // Mean square of the channel mix
+    float scale = 1.0f / channels;
+    double energy = 0.0;
+    for (int i = 0; i < frames; i++) {
+        float mix = 0.0f;
+        for (int ch = 0; ch < channels; ch++) {
+            mix += frame[i * channels + ch];
+        }
+        mix *= scale;
+        energy += (double)mix * mix;
+    }
+    float frameEnergy = (float)(energy / frames);
+
+    // Minimum statistics: follow quieter frames quickly, creep up slowly otherwise
+    if (floorEnergy < 0.0f) {
+        floorEnergy = frameEnergy;
+    }
+    else if (frameEnergy < floorEnergy) {
+        floorEnergy += FLOOR_FALL * (frameEnergy - floorEnergy);
+    }
+    else {
+        float riseDb = FLOOR_RISE_DB_PER_SEC * frames / sampleRate;
+        floorEnergy = std::min(frameEnergy, floorEnergy * DbToEnergy(riseDb));
+    }
+
+    // Only frames close to the floor describe the background, digital silence has no spectrum
+    if (frameEnergy <= 1e-12f || frameEnergy > floorEnergy * DbToEnergy(NOISE_MARGIN_DB)) {
+        return;
+    }
+
+    double lags[ORDER + 1] = {};
+    for (int lag = 0; lag <= ORDER; lag++) {
+        double sum = 0.0;
+        for (int i = lag; i < frames; i++) {
+            float a = 0.0f, b = 0.0f;
+            for (int ch = 0; ch < channels; ch++) {
+                a += frame[i * channels + ch];
+                b += frame[(i - lag) * channels + ch];
+            }
+            sum += (double)a * b;
+        }
+        lags[lag] = sum;
+    }
+
+    // Normalized, so loud and quiet noise frames weigh the same in the spectrum
+    if (lags[0] <= 0.0) {
+        return;
+    }
+    for (int lag = 0; lag <= ORDER; lag++) {
+        double normalized = lags[lag] / lags[0];
+        autocorrelation[lag] = haveModel
+            ? autocorrelation[lag] + AUTOCORRELATION_SMOOTHING * (normalized - autocorrelation[lag])
+            : normalized;
+    }
+    haveModel = true;
+    modelDirty = true;
+}
+
+// Levinson-Durbin on the smoothed autocorrelation
+void ComfortNoise::fitModel() {
+    modelDirty = false;
+
+    double r[ORDER + 1];
+    for (int lag = 0; lag <= ORDER; lag++) {
+        r[lag] = autocorrelation[lag];
+    }
+    r[0] *= WHITE_NOISE_CORRECTION;
+
+    double a[ORDER + 1] = { 1.0 };
+    double error = r[0];
+    for (int i = 1; i <= ORDER && error > 0.0; i++) {
+        double acc = r[i];
+        for (int j = 1; j < i; j++) {
+            acc += a[j] * r[i - j];
+        }
+        double k = -acc / error;
+
+        double previous[ORDER + 1];
+        memcpy(previous, a, sizeof(previous));
+        for (int j = 1; j < i; j++) {
+            a[j] = previous[j] + k * previous[i - j];
+        }
+        a[i] = k;
+        error *= 1.0 - k * k;
+    }
+
+    if (error <= 0.0 || r[0] <= 0.0) {
+        memset(lpc, 0, sizeof(lpc));
+        shapeGain = 1.0f;
+        return;
+    }
+    for (int j = 0; j < ORDER; j++) {
+        lpc[j] = (float)a[j + 1];
+    }
+    // White noise of variance v comes out of 1/A(z) with variance v * r0 / error
+    shapeGain = (float)sqrt(error / r[0]);
+}
+
+// Uniform noise in [-1, 1), four xorshift32 lanes at a time
+void ComfortNoise::fillWhite(float* out, int count) {
+    __m128i state = _mm_load_si128(reinterpret_cast<const __m128i*>(lanes));
+    const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(state), scale));
+    }
+    if (i < count) {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+        alignas(16) float tail[4];
+        _mm_store_ps(tail, _mm_mul_ps(_mm_cvtepi32_ps(state), scale));
+        for (int j = 0; i < count; i++, j++) {
+            out[i] = tail[j];
+        }
+    }
+
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), state);
+}
+
+void ComfortNoise::generate(float* out, int frames, int channels) {
+    if (!out || frames <= 0 || channels <= 0) {
+        return;
+    }
+    if (modelDirty) {
+        fitModel();
+    }
+
+    fillWhite(out, frames * channels);
+
+    // Measured floor, held inside the allowed range
+    float floorDb = std::max(MIN_LEVEL_DB, std::min(getFloorDb(), MAX_LEVEL_DB));
+    float gain = sqrtf(DbToEnergy(floorDb) / WHITE_VARIANCE) * shapeGain;
+
+    // All-pole synthesis per channel: y[n] = g * x[n] - sum(a[k] * y[n - k])
+    for (int ch = 0; ch < std::min(channels, MAX_CHANNELS); ch++) {
+        float* past = history[ch];
+        for (int i = 0; i < frames; i++) {
+            float y = gain * out[i * channels + ch];
+            for (int k = 0; k < ORDER; k++) {
+                y -= lpc[k] * past[k];
+            }
+            for (int k = ORDER - 1; k > 0; k--) {
+                past[k] = past[k - 1];
+            }
+            past[0] = y;
+            out[i * channels + ch] = y;
+        }
+    }
+
+    // Channels past the filtered ones get scaled white noise
+    for (int ch = MAX_CHANNELS; ch < channels; ch++) {
+        for (int i = 0; i < frames; i++) {
+            out[i * channels + ch] *= gain;
+        }
+    }
+}
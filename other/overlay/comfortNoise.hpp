@@ -0,0 +1,58 @@
+#pragma once
+
+// ComfortNoise - background noise for frames the gate has closed.
+//
+// Every frame is analyzed: a minimum-statistics tracker follows the noise floor, and
+// frames within NOISE_MARGIN_DB of it (the pauses between words and the silence
+// itself) update a smoothed autocorrelation. When the gate is closed, white noise
+// from four SSE2 xorshift32 lanes goes through the all-pole LPC filter fitted to that
+// autocorrelation, so the fill has the spectrum and level of the real background
+// instead of a flat hiss. The level is kept between MIN_LEVEL_DB and MAX_LEVEL_DB.
+// Nothing allocates and the noise is written straight into the caller's frame.
+class ComfortNoise {
+public:
+    static constexpr int ORDER = 10;
+    static constexpr int MAX_CHANNELS = 2;
+    static constexpr float NOISE_MARGIN_DB = 3.0f;       // Frames this close to the floor count as noise
+    static constexpr float FLOOR_RISE_DB_PER_SEC = 3.0f; // How fast the floor may creep back up
+    static constexpr float MIN_LEVEL_DB = -70.0f;        // Keeps the encoder fed when the input is digital silence
+    static constexpr float MAX_LEVEL_DB = -50.0f;        // Never louder than a quiet room
+
+    ComfortNoise();
+
+    // Reset the model when the sample rate changes
+    void configure(int sampleRate);
+
+    void reset();
+
+    // Measure one frame of interleaved input, call on every frame
+    void analyze(const float* frame, int frames, int channels);
+
+    // Write one frame of interleaved comfort noise
+    void generate(float* out, int frames, int channels);
+
+    // Estimated background level in dBFS
+    float getFloorDb() const;
+
+private:
+    int sampleRate = 0;
+
+    // Noise floor as mean square per sample, negative until the first frame
+    float floorEnergy = -1.0f;
+
+    // Smoothed autocorrelation of the noise frames and the filter fitted to it
+    double autocorrelation[ORDER + 1];
+    bool haveModel = false;
+    bool modelDirty = false;
+    float lpc[ORDER];
+    float shapeGain = 1.0f;    // Undoes the filter's gain on white noise
+
+    // Synthesis filter history per channel, newest first
+    float history[MAX_CHANNELS][ORDER];
+
+    // xorshift32 state of the four SIMD lanes
+    alignas(16) unsigned int lanes[4];
+
+    void fitModel();
+    void fillWhite(float* out, int count);
+};
@@ -0,0 +1,101 @@
+#include "complexityController.hpp"
+#include <algorithm> // For std::min, std::max
+
+const char* const ComplexityController::DECISION_NAMES[(int)ComplexityDecision::Count] = {
+    "None", "Lowered", "Raised", "Shed effects", "Restored effects"
+};
+
+void ComplexityController::setParams(float newBudget, bool shed) {
+    budget = std::max(0.1f, std::min(0.9f, newBudget));
+    allowShedding = shed;
+    if (!allowShedding && shedding) {
+        shedding = false;
+        publishedShedding.store(false, std::memory_order_relaxed);
+    }
+}
+
+void ComplexityController::setCeiling(int value) {
+    ceiling = std::max(MIN_COMPLEXITY, std::min(MAX_COMPLEXITY, value));
+    complexity = ceiling;
+    publishedComplexity.store(complexity, std::memory_order_relaxed);
+}
+
+void ComplexityController::reset() {
+    complexity = ceiling < 0 ? MAX_COMPLEXITY : ceiling;
+    shedding = false;
+    load = 0.0f;
+    effectsUs = 0.0f;
+    encodeUs = 0.0f;
+    overCount = 0;
+    underCount = 0;
+    settleRemaining = 0;
+
+    publishedLoad.store(0.0f, std::memory_order_relaxed);
+    publishedComplexity.store(complexity, std::memory_order_relaxed);
+    publishedShedding.store(false, std::memory_order_relaxed);
+}
+
+void ComplexityController::update(double frameEffectsUs, double frameEncodeUs, double frameUs) {
+    if (frameUs <= 0.0) return;
+
+    // Smoothed cost, as a fraction of the frame period
+    float frameLoad = (float)((frameEffectsUs + frameEncodeUs) / frameUs);
+    load += LOAD_SMOOTHING * (frameLoad - load);
+    effectsUs += LOAD_SMOOTHING * ((float)frameEffectsUs - effectsUs);
+    encodeUs += LOAD_SMOOTHING * ((float)frameEncodeUs - encodeUs);
+
+    publishedLoad.store(load, std::memory_order_relaxed);
+    publishedEffectsUs.store(effectsUs, std::memory_order_relaxed);
+    publishedEncodeUs.store(encodeUs, std::memory_order_relaxed);
+
+    // Let the smoothed load catch up with the last decision
+    if (settleRemaining > 0) {
+        settleRemaining--;
+        return;
+    }
+
+    if (load > budget) {
+        underCount = 0;
+        if (++overCount < OVER_FRAMES) return;
+
+        if (complexity > MIN_COMPLEXITY) {
+            complexity--;
+            decide(ComplexityDecision::Lowered);
+        }
+        else if (allowShedding && !shedding) {
+            shedding = true;
+            decide(ComplexityDecision::Shed);
+        }
+    }
+    else if (load < budget * LOW_WATERMARK) {
+        overCount = 0;
+        if (++underCount < UNDER_FRAMES) return;
+
+        // Effects come back first, they were the last thing to go
+        if (shedding) {
+            shedding = false;
+            decide(ComplexityDecision::Restored);
+        }
+        else if (complexity < std::max(ceiling, MIN_COMPLEXITY)) {
+            complexity++;
+            decide(ComplexityDecision::Raised);
+        }
+    }
+    else {
+        // Inside the hysteresis band: hold
+        overCount = 0;
+        underCount = 0;
+    }
+}
+
+void ComplexityController::decide(ComplexityDecision decision) {
+    overCount = 0;
+    underCount = 0;
+    settleRemaining = SETTLE_FRAMES;
+    decisionCount++;
+
+    publishedComplexity.store(complexity, std::memory_order_relaxed);
+    publishedShedding.store(shedding, std::memory_order_relaxed);
+    publishedDecision.store(decision, std::memory_order_relaxed);
+    publishedDecisionCount.store(decisionCount, std::memory_order_relaxed);
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+
+// What the controller did last, for the Infos tab
+enum class ComplexityDecision : int {
+    None = 0,
+    Lowered,        // Over budget: one complexity step down
+    Raised,         // Well under budget: one step back up towards the ceiling
+    Shed,           // Over budget at the lowest complexity: costly effects switched off
+    Restored,       // Well under budget again: costly effects back on
+    Count
+};
+
+// ComplexityController - keeps our effects plus the encoder inside a share of the frame period.
+//
+// The encode hook measures the wall time of the effect chain and of opus_encode
+// for every frame. The controller smooths their sum as a fraction of the frame
+// period and steers OPUS_SET_COMPLEXITY with hysteresis: a few frames over the
+// budget drop the complexity one step, a couple of seconds under the low
+// watermark raise it one step, never above the complexity the encoder had when
+// we first saw it. When it's already at the floor and still over budget it can
+// shed the costly effect stages too. After every decision it waits for the
+// smoothed load to settle before deciding again.
+class ComplexityController {
+public:
+    static constexpr int MIN_COMPLEXITY = 1;
+    static constexpr int MAX_COMPLEXITY = 10;
+
+    static const char* const DECISION_NAMES[(int)ComplexityDecision::Count];
+
+    ComplexityController() = default;
+
+    // Budget as a share of the frame period (0.1 - 0.9) and whether effects may be shed
+    void setParams(float budget, bool allowShedding);
+
+    // Encoder complexity before we touched it, the controller never goes above it
+    bool needsCeiling() const { return ceiling < 0; }
+    void setCeiling(int complexity);
+
+    void reset();
+
+    // Feed the cost of one frame, all in microseconds
+    void update(double effectsUs, double encodeUs, double frameUs);
+
+    // Complexity the encoder should run at
+    int getComplexity() const { return complexity; }
+
+    // Costly effect stages should be skipped
+    bool isShedding() const { return shedding; }
+
+    // Published state, safe to read from any thread
+    float getLoad() const { return publishedLoad.load(std::memory_order_relaxed); }
+    float getEffectsUs() const { return publishedEffectsUs.load(std::memory_order_relaxed); }
+    float getEncodeUs() const { return publishedEncodeUs.load(std::memory_order_relaxed); }
+    int getPublishedComplexity() const { return publishedComplexity.load(std::memory_order_relaxed); }
+    bool getPublishedShedding() const { return publishedShedding.load(std::memory_order_relaxed); }
+    ComplexityDecision getLastDecision() const { return publishedDecision.load(std::memory_order_relaxed); }
+    unsigned int getDecisionCount() const { return publishedDecisionCount.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr float LOAD_SMOOTHING = 0.1f;      // EMA coefficient, ~10 frames
+    static constexpr float LOW_WATERMARK = 0.6f;       // Share of the budget that counts as well under
+    static constexpr int OVER_FRAMES = 5;              // ~100 ms over budget before stepping down
+    static constexpr int UNDER_FRAMES = 100;           // ~2 s under the watermark before stepping up
+    static constexpr int SETTLE_FRAMES = 25;           // Frames ignored after a decision
+
+    float budget = 0.5f;
+    bool allowShedding = false;
+
+    int ceiling = -1;               // -1 = not known yet
+    int complexity = MAX_COMPLEXITY;
+    bool shedding = false;
+
+    float load = 0.0f;              // Smoothed cost / frame period
+    float effectsUs = 0.0f;
+    float encodeUs = 0.0f;
+    int overCount = 0;
+    int underCount = 0;
+    int settleRemaining = 0;
+    unsigned int decisionCount = 0;
+
+    std::atomic<float> publishedLoad{ 0.0f };
+    std::atomic<float> publishedEffectsUs{ 0.0f };
+    std::atomic<float> publishedEncodeUs{ 0.0f };
+    std::atomic<int> publishedComplexity{ MAX_COMPLEXITY };
+    std::atomic<bool> publishedShedding{ false };
+    std::atomic<ComplexityDecision> publishedDecision{ ComplexityDecision::None };
+    std::atomic<unsigned int> publishedDecisionCount{ 0 };
+
+    void decide(ComplexityDecision decision);
+};
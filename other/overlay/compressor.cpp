@@ -0,0 +1,121 @@
+#include "compressor.hpp"
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For expf, powf, log10f, fabsf
+
+void Compressor::configure(int rate, int numChannels) {
+    rate = std::max(8000, rate);
+    numChannels = std::max(1, std::min(numChannels, MAX_CHANNELS));
+    if (rate == sampleRate && numChannels == channels) return;
+
+    sampleRate = rate;
+    channels = numChannels;
+    updateCoefficients();
+    reset();
+}
+
+void Compressor::setParams(float threshold, float newRatio, float knee, float attack, float release, float makeup, bool link) {
+    thresholdDb = threshold;
+    ratio = std::max(1.0f, newRatio);
+    kneeDb = std::max(0.0f, knee);
+    makeupDb = makeup;
+    linked = link;
+
+    if (attack == attackMs && release == releaseMs) return;
+    attackMs = attack;
+    releaseMs = release;
+    updateCoefficients();
+}
+
+void Compressor::updateCoefficients() {
+    if (sampleRate <= 0) return;
+
+    // Time constants are counted in sub-blocks, the smoother only runs once per block
+    float blockMs = 1000.0f * SUB_BLOCK_FRAMES / sampleRate;
+    attackCoeff = 1.0f - expf(-blockMs / std::max(attackMs, blockMs));
+    releaseCoeff = 1.0f - expf(-blockMs / std::max(releaseMs, blockMs));
+}
+
+void Compressor::reset() {
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+        reductionDb[ch] = 0.0f;
+        gain[ch] = powf(10.0f, makeupDb / 20.0f);
+    }
+    publishedReductionDb.store(0.0f, std::memory_order_relaxed);
+}
+
+// Static curve: gain change in dB for a detector level, quadratic inside the knee
+float Compressor::computeReduction(float levelDb) const {
+    float over = levelDb - thresholdDb;
+    float slope = 1.0f / ratio - 1.0f;
+
+    if (2.0f * over <= -kneeDb) {
+        return 0.0f;
+    }
+    if (2.0f * fabsf(over) < kneeDb) {
+        float x = over + kneeDb * 0.5f;
+        return slope * x * x / (2.0f * kneeDb);
+    }
+    return slope * over;
+}
+
+// Attack when the reduction deepens, release when it recovers
+float Compressor::smoothReduction(int ch, float targetDb) {
+    float coeff = targetDb < reductionDb[ch] ? attackCoeff : releaseCoeff;
+    reductionDb[ch] += coeff * (targetDb - reductionDb[ch]);
+    return reductionDb[ch];
+}
+
+void Compressor::process(float* buffer, int frames) {
+    if (!buffer || frames <= 0 || channels <= 0) return;
+
+    float deepestDb = 0.0f;
+
+    for (int start = 0; start < frames; start += SUB_BLOCK_FRAMES) {
+        int count = std::min(SUB_BLOCK_FRAMES, frames - start);
+        float* block = buffer + start * channels;
+
+        // Detector: peak of each channel over the sub-block
+        float peak[MAX_CHANNELS] = {};
+        for (int n = 0; n < count; n++) {
+            for (int ch = 0; ch < channels; ch++) {
+                peak[ch] = std::max(peak[ch], fabsf(block[n * channels + ch]));
+            }
+        }
+
+        // Gain computer and smoothing, once per sub-block
+        float target[MAX_CHANNELS];
+        if (linked) {
+            float loudest = peak[0];
+            for (int ch = 1; ch < channels; ch++) loudest = std::max(loudest, peak[ch]);
+
+            float levelDb = 20.0f * log10f(std::max(loudest, 1e-6f));
+            float smoothed = smoothReduction(0, computeReduction(levelDb));
+            for (int ch = 0; ch < channels; ch++) {
+                reductionDb[ch] = smoothed;
+                target[ch] = powf(10.0f, (smoothed + makeupDb) / 20.0f);
+            }
+            deepestDb = std::min(deepestDb, smoothed);
+        }
+        else {
+            for (int ch = 0; ch < channels; ch++) {
+                float levelDb = 20.0f * log10f(std::max(peak[ch], 1e-6f));
+                float smoothed = smoothReduction(ch, computeReduction(levelDb));
+                target[ch] = powf(10.0f, (smoothed + makeupDb) / 20.0f);
+                deepestDb = std::min(deepestDb, smoothed);
+            }
+        }
+
+        // Ramp each channel's gain linearly to the new target across the sub-block
+        for (int ch = 0; ch < channels; ch++) {
+            float step = (target[ch] - gain[ch]) / count;
+            float g = gain[ch];
+            for (int n = 0; n < count; n++) {
+                g += step;
+                block[n * channels + ch] *= g;
+            }
+            gain[ch] = target[ch];
+        }
+    }
+
+    publishedReductionDb.store(deepestDb, std::memory_order_relaxed);
+}
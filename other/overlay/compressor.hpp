@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+
+// Compressor - feed-forward downward compressor with a soft knee.
+//
+// The detector and gain computer run once per 8-frame sub-block instead of per
+// sample: each sub-block's peak goes through the static curve (threshold, ratio,
+// knee), the gain reduction is smoothed in dB with attack/release, and the
+// resulting gain is ramped linearly across the sub-block. Per sample that leaves
+// one abs/max and one multiply-add. Linked mode drives every channel from the
+// loudest one so the stereo image stays put; unlinked mode keeps one detector and
+// gain per channel.
+class Compressor {
+public:
+    static constexpr int MAX_CHANNELS = 2;
+    static constexpr int SUB_BLOCK_FRAMES = 8;
+
+    Compressor() = default;
+
+    // Set format, resets the state when it changes
+    void configure(int sampleRate, int numChannels);
+
+    // Curve and timing. Cheap when nothing changed, can be called every block.
+    void setParams(float thresholdDb, float ratio, float kneeDb, float attackMs, float releaseMs, float makeupDb, bool linked);
+
+    void reset();
+
+    // Compress a block of interleaved audio in place
+    void process(float* buffer, int frames);
+
+    // Current gain reduction in dB (<= 0), safe to read from any thread
+    float getGainReductionDb() const { return publishedReductionDb.load(std::memory_order_relaxed); }
+
+private:
+    float thresholdDb = -18.0f;
+    float ratio = 4.0f;
+    float kneeDb = 6.0f;
+    float attackMs = -1.0f;
+    float releaseMs = -1.0f;
+    float makeupDb = 0.0f;
+    bool linked = true;
+
+    // Per sub-block smoothing coefficients
+    float attackCoeff = 0.0f;
+    float releaseCoeff = 0.0f;
+
+    // Smoothed gain reduction in dB and the linear gain currently applied, per channel
+    float reductionDb[MAX_CHANNELS] = {};
+    float gain[MAX_CHANNELS] = { 1.0f, 1.0f };
+
+    int sampleRate = 0;
+    int channels = 0;
+
+    std::atomic<float> publishedReductionDb{ 0.0f };
+
+    void updateCoefficients();
+    float computeReduction(float levelDb) const;
+    float smoothReduction(int ch, float targetDb);
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <intrin.h>
+
+// Runtime CPU feature checks for the optional SIMD code paths. Results are computed
+// once and cached, so these are cheap enough to call from the audio thread.
+namespace CpuFeatures {
+    // AVX state (YMM registers) enabled by the CPU and saved by the OS -
+    // required for any VEX encoded instruction, including F16C
+    inline bool hasAvx() {
+        static const bool supported = [] {
+            int info[4] = {};
+            __cpuid(info, 1);
+            bool osxsave = (info[2] & (1 << 27)) != 0;
+            bool avx = (info[2] & (1 << 28)) != 0;
+            return osxsave && avx && (_xgetbv(0) & 0x6) == 0x6;
+        }();
+        return supported;
+    }
+
+    // Half precision conversions (_cvtss_sh / _cvtsh_ss)
+    inline bool hasF16C() {
+        static const bool supported = [] {
+            int info[4] = {};
+            __cpuid(info, 1);
+            return hasAvx() && (info[2] & (1 << 29)) != 0;
+        }();
+        return supported;
+    }
+}
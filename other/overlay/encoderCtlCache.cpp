@@ -0,0 +1,159 @@
+#include "encoderCtlCache.hpp"
+
+void EncoderCtlCache::reset() {
+    framesUntilRevalidate = 0;
+    channels = 0;
+    sampleRate = 0;
+    bitrate = -1;
+    forceChannels = -1;
+    dtx = -1;
+    complexity = -1;
+    inbandFec = -1;
+    packetLossPercent = -1;
+}
+
+void EncoderCtlCache::beginFrame(OpusEncoder* st) {
+    if (!caching || --framesUntilRevalidate > 0) return;
+    framesUntilRevalidate = REVALIDATE_FRAMES;
+
+    // OPUS_GET_BITRATE (4003), OPUS_GET_FORCE_CHANNELS (4023), OPUS_GET_DTX (4017),
+    // OPUS_GET_COMPLEXITY (4011), OPUS_GET_INBAND_FEC (4013), OPUS_GET_PACKET_LOSS_PERC (4015)
+    opus_int32 value = 0;
+    if (bitrate != -1 && (opus_encoder_ctl(st, 4003, &value) != OPUS_OK || value != bitrate)) {
+        bitrate = -1;
+    }
+    if (forceChannels != -1 && (opus_encoder_ctl(st, 4023, &value) != OPUS_OK || value != forceChannels)) {
+        forceChannels = -1;
+    }
+    if (dtx != -1 && (opus_encoder_ctl(st, 4017, &value) != OPUS_OK || value != dtx)) {
+        dtx = -1;
+    }
+    if (complexity != -1 && (opus_encoder_ctl(st, 4011, &value) != OPUS_OK || value != complexity)) {
+        complexity = -1;
+    }
+    if (inbandFec != -1 && (opus_encoder_ctl(st, 4013, &value) != OPUS_OK || value != inbandFec)) {
+        inbandFec = -1;
+    }
+    if (packetLossPercent != -1 && (opus_encoder_ctl(st, 4015, &value) != OPUS_OK || value != packetLossPercent)) {
+        packetLossPercent = -1;
+    }
+}
+
+void EncoderCtlCache::checkFormat(int& known, int value) {
+    if (known && known != value) {
+        reset();
+    }
+    known = value;
+}
+
+int EncoderCtlCache::getChannels(OpusEncoder* st, int fallback) {
+    // OPUS_GET_CHANNELS_REQUEST (1029)
+    opus_int32 value = 0;
+    if (opus_encoder_ctl(st, 1029, &value) != OPUS_OK || value <= 0) {
+        return fallback;
+    }
+    checkFormat(channels, (int)value);
+    return channels;
+}
+
+int EncoderCtlCache::getSampleRate(OpusEncoder* st, int fallback) {
+    // OPUS_GET_SAMPLE_RATE_REQUEST (4029)
+    opus_int32 value = 0;
+    if (opus_encoder_ctl(st, 4029, &value) != OPUS_OK || value <= 0) {
+        return fallback;
+    }
+    checkFormat(sampleRate, (int)value);
+    return sampleRate;
+}
+
+int EncoderCtlCache::getComplexity(OpusEncoder* st, int fallback) {
+    if (caching && complexity != -1) {
+        savedCalls++;
+        return complexity;
+    }
+
+    // OPUS_GET_COMPLEXITY_REQUEST (4011)
+    opus_int32 value = 0;
+    if (opus_encoder_ctl(st, 4011, &value) != OPUS_OK) {
+        return fallback;
+    }
+    complexity = (int)value;
+    return complexity;
+}
+
+void EncoderCtlCache::setBitrate(OpusEncoder* st, int value) {
+    if (caching && value == bitrate) {
+        savedCalls++;
+        return;
+    }
+
+    // OPUS_SET_BITRATE_REQUEST (4002), only cache what the encoder accepted
+    bitrate = opus_encoder_ctl(st, 4002, value) == OPUS_OK ? value : -1;
+}
+
+void EncoderCtlCache::setForceChannels(OpusEncoder* st, int value) {
+    if (caching && value == forceChannels) {
+        savedCalls++;
+        return;
+    }
+
+    // OPUS_SET_FORCE_CHANNELS_REQUEST (4022)
+    forceChannels = opus_encoder_ctl(st, 4022, value) == OPUS_OK ? value : -1;
+}
+
+int EncoderCtlCache::queryDtx(OpusEncoder* st, int fallback) {
+    // OPUS_GET_DTX_REQUEST (4017)
+    opus_int32 value = 0;
+    if (opus_encoder_ctl(st, 4017, &value) != OPUS_OK) {
+        dtx = -1;
+        return fallback;
+    }
+    dtx = (int)value;
+    return dtx;
+}
+
+void EncoderCtlCache::setDtx(OpusEncoder* st, int value) {
+    if (caching && value == dtx) {
+        savedCalls++;
+        return;
+    }
+
+    // OPUS_SET_DTX_REQUEST (4016)
+    dtx = opus_encoder_ctl(st, 4016, value) == OPUS_OK ? value : -1;
+}
+
+void EncoderCtlCache::setComplexity(OpusEncoder* st, int value) {
+    if (caching && value == complexity) {
+        savedCalls++;
+        return;
+    }
+
+    // OPUS_SET_COMPLEXITY_REQUEST (4010)
+    complexity = opus_encoder_ctl(st, 4010, value) == OPUS_OK ? value : -1;
+}
+
+void EncoderCtlCache::setInbandFec(OpusEncoder* st, int value) {
+    if (caching && value == inbandFec) {
+        savedCalls++;
+        return;
+    }
+
+    // OPUS_SET_INBAND_FEC_REQUEST (4012)
+    inbandFec = opus_encoder_ctl(st, 4012, value) == OPUS_OK ? value : -1;
+}
+
+void EncoderCtlCache::setPacketLossPercent(OpusEncoder* st, int value) {
+    if (caching && value == packetLossPercent) {
+        savedCalls++;
+        return;
+    }
+
+    // OPUS_SET_PACKET_LOSS_PERC_REQUEST (4014)
+    packetLossPercent = opus_encoder_ctl(st, 4014, value) == OPUS_OK ? value : -1;
+}
+
+unsigned long long EncoderCtlCache::takeSavedCalls() {
+    unsigned long long saved = savedCalls;
+    savedCalls = 0;
+    return saved;
+}
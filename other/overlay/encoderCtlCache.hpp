@@ -0,0 +1,76 @@
+#pragma once
+#include "libraries/opus/include/opus.h"
+
+// EncoderCtlCache - the encoder settings we last applied to one OpusEncoder.
+//
+// The encode hook used to query the format and push bitrate and channel mode on
+// every frame, and a bitrate set can make libopus recompute its rate allocation.
+// With the cache those ctls only go out when the wanted value differs from what
+// the encoder already has. Channels and sample rate are read from the encoder on
+// every call and never cached: a cache is keyed by the encoder's address, and an
+// encoder created where a freed one lived inherits it. When the format read differs
+// from the last one, it is such a new encoder and every applied value is forgotten.
+// Discord also sets the bitrate itself, so every
+// REVALIDATE_FRAMES the applied values are read back (cheap GET ctls) and any
+// that were changed behind our back get pushed again.
+class EncoderCtlCache {
+public:
+    // Frames between read-backs of the applied values, one second at 20 ms frames
+    static constexpr int REVALIDATE_FRAMES = 50;
+
+    EncoderCtlCache() = default;
+
+    // With caching off every call goes straight to the encoder (used by the benchmark)
+    void setCaching(bool enabled) { caching = enabled; }
+
+    // Forget everything, the next calls hit the encoder again
+    void reset();
+
+    // Call once per frame before the setters, re-reads the applied values now and then
+    void beginFrame(OpusEncoder* st);
+
+    // OPUS_GET_CHANNELS / OPUS_GET_SAMPLE_RATE, always queried, fallback when that fails
+    int getChannels(OpusEncoder* st, int fallback);
+    int getSampleRate(OpusEncoder* st, int fallback);
+
+    // OPUS_GET_COMPLEXITY, the value we set last if we did
+    int getComplexity(OpusEncoder* st, int fallback);
+
+    // OPUS_GET_DTX straight from the encoder, so it sees what the host set in the
+    // meantime. Refreshes the cached value.
+    int queryDtx(OpusEncoder* st, int fallback);
+
+    // OPUS_SET_BITRATE / OPUS_SET_FORCE_CHANNELS / OPUS_SET_DTX / OPUS_SET_COMPLEXITY
+    void setBitrate(OpusEncoder* st, int bitrate);
+    void setForceChannels(OpusEncoder* st, int channels);
+    void setDtx(OpusEncoder* st, int dtx);
+    void setComplexity(OpusEncoder* st, int complexity);
+
+    // OPUS_SET_INBAND_FEC / OPUS_SET_PACKET_LOSS_PERC
+    void setInbandFec(OpusEncoder* st, int fec);
+    void setPacketLossPercent(OpusEncoder* st, int percent);
+
+    // Last DTX value we set, -1 before the first setDtx()
+    int getDtx() const { return dtx; }
+
+    // ctl calls skipped since the last call, for the UI counter
+    unsigned long long takeSavedCalls();
+
+private:
+    bool caching = true;
+    int framesUntilRevalidate = 0;
+
+    int channels = 0;       // Last format read, 0 = not queried yet
+    int sampleRate = 0;
+    int bitrate = -1;       // -1 = not set yet
+    int forceChannels = -1;
+    int dtx = -1;
+    int complexity = -1;
+    int inbandFec = -1;
+    int packetLossPercent = -1;
+
+    unsigned long long savedCalls = 0;
+
+    // A different format than last time means a different encoder
+    void checkFormat(int& known, int value);
+};
@@ -0,0 +1,72 @@
+#include "framePacker.hpp"
+#include <algorithm> // For std::min
+#include <cstring>   // For memcpy
+
+FramePacker::~FramePacker() {
+    if (repacketizer) {
+        opus_repacketizer_destroy(repacketizer);
+    }
+}
+
+void FramePacker::reset() {
+    count = 0;
+    pendingBytes = 0;
+    if (repacketizer) {
+        opus_repacketizer_init(repacketizer);
+    }
+}
+
+// Copy the packet into the group, false if it can't join
+bool FramePacker::add(const unsigned char* packet, int length, int maxBytes) {
+    if (length > SLOT_BYTES || count >= MAX_FRAMES) return false;
+
+    // Code 3 framing: TOC, frame count and up to two length bytes per frame
+    if (pendingBytes + length + 2 + 2 * (count + 1) > maxBytes) return false;
+
+    if (!repacketizer) {
+        repacketizer = opus_repacketizer_create();
+        if (!repacketizer) return false;
+    }
+
+    // The repacketizer keeps pointers to the frames, they have to live in our slots
+    memcpy(slots[count], packet, length);
+    if (opus_repacketizer_cat(repacketizer, slots[count], length) != OPUS_OK) return false;
+
+    count++;
+    pendingBytes += length;
+    return true;
+}
+
+int FramePacker::flush(unsigned char* out, int maxDataBytes) {
+    int length = opus_repacketizer_out(repacketizer, out, maxDataBytes);
+    reset();
+    return length;
+}
+
+int FramePacker::push(unsigned char* data, int length, int framesPerPacket, int maxDataBytes) {
+    // Encoder errors go straight back
+    if (length <= 0) return length;
+
+    framesPerPacket = std::min(framesPerPacket, MAX_FRAMES);
+    if (framesPerPacket <= 1 && count == 0) return length;
+
+    int maxBytes = std::min(maxDataBytes, PACKED_BYTE_LIMIT);
+    if (add(data, length, maxBytes)) {
+        if (count < framesPerPacket) return 0;
+        return flush(data, maxDataBytes);
+    }
+
+    // This packet can't join the group: send the group now and start the next one with it
+    if (count == 0) return length;
+
+    unsigned char current[SLOT_BYTES];
+    bool keep = length <= SLOT_BYTES && framesPerPacket > 1;
+    if (keep) {
+        memcpy(current, data, length);
+    }
+    int sent = flush(data, maxDataBytes);
+    if (keep) {
+        add(current, length, maxBytes);
+    }
+    return sent;
+}
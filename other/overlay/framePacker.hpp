@@ -0,0 +1,47 @@
+#pragma once
+#include "libraries/opus/include/opus.h"
+
+// FramePacker - combines consecutive Opus packets into one longer packet.
+//
+// The packets of N calls are collected with opus_repacketizer and come out as one
+// 40/60 ms packet on the Nth call, saving N-1 packet headers for (N-1) frames of
+// latency. A group is sent early when the next packet can't join it: a different
+// TOC (mode, bandwidth or channel change) or a combined size past
+// PACKED_BYTE_LIMIT, which keeps packets inside one UDP datagram.
+//
+// Offline only, for the frame duration benchmark. It can't sit in the encode hook:
+// the voice engine treats an encode that returns 0 bytes as a failure, not as
+// "nothing to send" (DTX sends 1-2 byte packets instead), and it stamps RTP time
+// per call, so the calls in between have nothing valid to return.
+class FramePacker {
+public:
+    static constexpr int MAX_FRAMES = 6;            // 120 ms of 20 ms frames, the Opus packet limit
+    static constexpr int SLOT_BYTES = 1275;         // Largest single Opus frame
+    static constexpr int PACKED_BYTE_LIMIT = 1200;  // Stay below a typical MTU after RTP/UDP/IP headers
+
+    FramePacker() = default;
+    ~FramePacker();
+    FramePacker(const FramePacker&) = delete;
+    FramePacker& operator=(const FramePacker&) = delete;
+
+    // Drop anything collected so far
+    void reset();
+
+    // Add the packet the encoder just wrote to data and write what should be sent
+    // back into data. Returns the length to send: 0 while a group is being
+    // collected, the combined packet once framesPerPacket packets are in, or the
+    // packet itself when packing is off (framesPerPacket <= 1) and nothing is pending.
+    int push(unsigned char* data, int length, int framesPerPacket, int maxDataBytes);
+
+    // Packets collected for the current group
+    int pendingFrames() const { return count; }
+
+private:
+    OpusRepacketizer* repacketizer = nullptr;
+    unsigned char slots[MAX_FRAMES][SLOT_BYTES];
+    int count = 0;
+    int pendingBytes = 0;
+
+    bool add(const unsigned char* packet, int length, int maxBytes);
+    int flush(unsigned char* out, int maxDataBytes);
+};
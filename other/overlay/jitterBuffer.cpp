@@ -0,0 +1,180 @@
+#include "jitterBuffer.hpp"
+#include <algorithm> // For std::min, std::max, std::nth_element
+#include <cmath>     // For ceil
+#include <cstring>   // For memcpy, memset
+
+namespace {
+    constexpr int MAX_DECODE_SAMPLES = 5760;    // 120 ms at 48 kHz, the longest Opus packet
+}
+
+void JitterBuffer::configure(int rate, int size, float newQuantile, float newFixedDelayMs) {
+    sampleRate = std::max(8000, rate);
+    frameSize = std::max(1, std::min(size, MAX_DECODE_SAMPLES));
+    quantile = std::max(0.0f, std::min(newQuantile, 0.999f));
+    fixedDelayMs = std::max(0.0f, newFixedDelayMs);
+    reset();
+}
+
+void JitterBuffer::reset() {
+    for (Slot& slot : slots) {
+        slot.used = false;
+    }
+    started = false;
+    playoutTimestamp = 0;
+    targetDelayMs = 0.0f;
+    minTransitMs = 0.0;
+    haveTransit = false;
+    transitCount = 0;
+    transitPos = 0;
+    stats = Stats();
+}
+
+JitterBuffer::Slot* JitterBuffer::find(long long timestamp) {
+    for (Slot& slot : slots) {
+        if (slot.used && slot.timestamp == timestamp) return &slot;
+    }
+    return nullptr;
+}
+
+JitterBuffer::Slot* JitterBuffer::earliest() {
+    Slot* first = nullptr;
+    for (Slot& slot : slots) {
+        if (slot.used && (!first || slot.timestamp < first->timestamp)) first = &slot;
+    }
+    return first;
+}
+
+void JitterBuffer::updateTarget(double transitMs) {
+    minTransitMs = haveTransit ? std::min(minTransitMs, transitMs) : transitMs;
+    haveTransit = true;
+
+    // A fixed buffer holds a constant delay over the fastest packet so far
+    if (quantile <= 0.0f) {
+        targetDelayMs = (float)(minTransitMs + fixedDelayMs);
+        return;
+    }
+
+    transits[transitPos] = (float)transitMs;
+    transitPos = (transitPos + 1) % DELAY_WINDOW;
+    transitCount = std::min(transitCount + 1, DELAY_WINDOW);
+
+    // Quantile of the window, O(window) per packet
+    memcpy(sorted, transits, sizeof(float) * transitCount);
+    int rank = (int)(quantile * (transitCount - 1) + 0.5f);
+    std::nth_element(sorted, sorted + rank, sorted + transitCount);
+    targetDelayMs = sorted[rank];
+}
+
+void JitterBuffer::insert(const unsigned char* data, int length, long long timestamp, double arrivalMs) {
+    if (length <= 0 || length > MAX_PACKET_BYTES) {
+        stats.overflow++;
+        return;
+    }
+
+    // Late packets still say something about the network
+    updateTarget(arrivalMs - sendMs(timestamp));
+
+    if (started && timestamp < playoutTimestamp) {
+        stats.late++;
+        return;
+    }
+    if (find(timestamp)) return;    // Duplicate
+
+    for (Slot& slot : slots) {
+        if (slot.used) continue;
+        slot.used = true;
+        slot.timestamp = timestamp;
+        slot.length = length;
+        memcpy(slot.data, data, length);
+        return;
+    }
+    stats.overflow++;
+}
+
+double JitterBuffer::getPlayoutDelayMs(double nowMs) const {
+    return started ? nowMs - sendMs(playoutTimestamp) : 0.0;
+}
+
+int JitterBuffer::decodeSlot(OpusDecoder* decoder, Slot* slot, opus_int16* pcm, int fec, int samples) {
+    if (slot) {
+        return opus_decode(decoder, slot->data, slot->length, pcm, samples, fec);
+    }
+    return opus_decode(decoder, nullptr, 0, pcm, samples, 0);
+}
+
+int JitterBuffer::pull(OpusDecoder* decoder, opus_int16* pcm, int channels, double nowMs, FrameSource& source) {
+    // Fill up to the target before the first frame
+    if (!started) {
+        Slot* first = earliest();
+        double waitMs = first ? targetDelayMs - (nowMs - sendMs(first->timestamp)) : frameSize * 1000.0 / sampleRate;
+        if (waitMs > 0.0) {
+            // Only as much silence as is left to wait, so playback starts right on the target
+            int samples = std::max(1, std::min(frameSize, (int)ceil(waitMs * sampleRate / 1000.0)));
+            memset(pcm, 0, sizeof(opus_int16) * samples * channels);
+            source = FrameSource::Waiting;
+            return samples;
+        }
+        started = true;
+        playoutTimestamp = first->timestamp;
+    }
+
+    double frameMs = frameSize * 1000.0 / sampleRate;
+    double delayMs = nowMs - sendMs(playoutTimestamp);
+    int samples = 0;
+
+    if (delayMs < targetDelayMs) {
+        // Too little buffered: play a concealed frame and hold the playout position
+        samples = decodeSlot(decoder, nullptr, pcm, 0, frameSize);
+        source = FrameSource::Stretch;
+    }
+    else {
+        // Too much buffered: drop the packet whose turn it is
+        if (delayMs > targetDelayMs + SKIP_MARGIN_FRAMES * frameMs) {
+            Slot* skipped = find(playoutTimestamp);
+            int skippedSamples = frameSize;
+            if (skipped) {
+                int packetSamples = opus_packet_get_nb_samples(skipped->data, skipped->length, sampleRate);
+                skippedSamples = packetSamples > 0 ? packetSamples : frameSize;
+                skipped->used = false;
+            }
+            playoutTimestamp += skippedSamples;
+            stats.skipped++;
+        }
+
+        if (Slot* slot = find(playoutTimestamp)) {
+            samples = decodeSlot(decoder, slot, pcm, 0, MAX_DECODE_SAMPLES);
+            slot->used = false;
+            source = FrameSource::Packet;
+        }
+        else if (Slot* next = find(playoutTimestamp + frameSize)) {
+            samples = decodeSlot(decoder, next, pcm, 1, frameSize);
+            source = FrameSource::Fec;
+        }
+        else {
+            samples = decodeSlot(decoder, nullptr, pcm, 0, frameSize);
+            source = FrameSource::Plc;
+        }
+        if (samples <= 0) {
+            samples = frameSize;
+            memset(pcm, 0, sizeof(opus_int16) * frameSize * channels);
+        }
+        playoutTimestamp += samples;
+
+        // Packets that don't line up with the playout position would never play.
+        // They arrived in time, so they're not counted as late.
+        for (Slot& slot : slots) {
+            if (slot.used && slot.timestamp < playoutTimestamp) {
+                slot.used = false;
+                stats.misaligned++;
+            }
+        }
+    }
+
+    if (samples <= 0) {
+        samples = frameSize;
+        memset(pcm, 0, sizeof(opus_int16) * frameSize * channels);
+    }
+    stats.played[(int)source]++;
+    stats.delaySumMs += delayMs;
+    return samples;
+}
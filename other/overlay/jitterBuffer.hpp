@@ -0,0 +1,107 @@
+#pragma once
+#include "libraries/opus/include/opus.h"
+
+// JitterBuffer - receive-side stand-in for the network path, used for offline runs.
+//
+// Packets go in with their sender timestamp and arrival time; pull() plays one
+// packet's worth of audio per call on the receiver's clock. The playout delay is
+// how far that clock runs behind the sender. In adaptive mode its target is a
+// quantile of the transit times of the last DELAY_WINDOW packets, so the chosen
+// share of packets is on time; in fixed mode it is a constant on top of the
+// fastest transit seen. The delay only moves in whole frames: a concealed frame is
+// inserted to grow it, a buffered packet is dropped to shrink it, with
+// SKIP_MARGIN_FRAMES of hysteresis between the two.
+//
+// A packet that isn't there when its turn comes is rebuilt from the in-band FEC
+// of the packet after it when that one has arrived, otherwise concealed with
+// PLC, both through opus_decode. A packet arriving after its turn is dropped.
+// Storage is fixed, nothing allocates after construction.
+class JitterBuffer {
+public:
+    static constexpr int CAPACITY = 64;             // Buffered packets, over a second of 20 ms packets
+    static constexpr int MAX_PACKET_BYTES = 1500;
+    static constexpr int DELAY_WINDOW = 250;        // Transit history, 5 s of 20 ms packets
+    static constexpr float SKIP_MARGIN_FRAMES = 1.5f;
+
+    // Where a played frame came from
+    enum class FrameSource : int {
+        Waiting = 0,    // Still filling up before the first frame, silence
+        Packet,         // Its own packet
+        Fec,            // In-band FEC of the next packet
+        Plc,            // Packet loss concealment
+        Stretch,        // Concealment inserted to grow the delay
+        Count
+    };
+
+    struct Stats {
+        int played[(int)FrameSource::Count] = {};
+        int skipped = 0;        // Packets dropped to shrink the delay
+        int late = 0;           // Packets that came after their turn
+        int misaligned = 0;     // Packets passed over because they started mid-frame
+        int overflow = 0;       // Packets that didn't fit
+        double delaySumMs = 0.0; // Playout delay summed over played frames
+    };
+
+    JitterBuffer() = default;
+
+    // Sample rate of the timestamps and decoder, nominal frame size in samples.
+    // quantile in (0, 1) makes the delay adaptive, 0 keeps it at fixedDelayMs past
+    // the fastest packet's transit.
+    void configure(int sampleRate, int frameSize, float quantile, float fixedDelayMs);
+
+    void reset();
+
+    // Queue a packet sent at timestamp (samples) that arrived at arrivalMs
+    void insert(const unsigned char* data, int length, long long timestamp, double arrivalMs);
+
+    // Play the next frame at nowMs into pcm (room for 120 ms per channel).
+    // Returns the samples per channel written, the caller's clock advances by that.
+    int pull(OpusDecoder* decoder, opus_int16* pcm, int channels, double nowMs, FrameSource& source);
+
+    // Current target and actual playout delay, in ms of transit
+    float getTargetDelayMs() const { return targetDelayMs; }
+    double getPlayoutDelayMs(double nowMs) const;
+
+    // Timestamp of the next frame to play
+    long long getPlayoutTimestamp() const { return playoutTimestamp; }
+    bool hasStarted() const { return started; }
+
+    // Smallest transit seen, the part of the delay no buffer can avoid
+    double getMinTransitMs() const { return minTransitMs; }
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Slot {
+        bool used = false;
+        long long timestamp = 0;
+        int length = 0;
+        unsigned char data[MAX_PACKET_BYTES];
+    };
+
+    Slot slots[CAPACITY];
+
+    int sampleRate = 48000;
+    int frameSize = 960;
+    float quantile = 0.0f;
+    float fixedDelayMs = 0.0f;
+
+    bool started = false;
+    long long playoutTimestamp = 0;
+    float targetDelayMs = 0.0f;
+    double minTransitMs = 0.0;
+    bool haveTransit = false;
+
+    float transits[DELAY_WINDOW] = {};
+    float sorted[DELAY_WINDOW] = {};
+    int transitCount = 0;
+    int transitPos = 0;
+
+    Stats stats;
+
+    double sendMs(long long timestamp) const { return timestamp * 1000.0 / sampleRate; }
+    Slot* find(long long timestamp);
+    Slot* earliest();
+    void updateTarget(double transitMs);
+    int decodeSlot(OpusDecoder* decoder, Slot* slot, opus_int16* pcm, int fec, int samples);
+};
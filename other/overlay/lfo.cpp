@@ -0,0 +1,129 @@
+#include "lfo.hpp"
+#include <emmintrin.h>
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For floor
+
+const char* const Lfo::NAMES[(int)LfoShape::Count] = {
+    "Sine", "Triangle", "Square", "Random"
+};
+
+namespace {
+    inline __m128 Abs(__m128 x) {
+        return _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+    }
+
+    // Fractional part for non-negative values
+    inline __m128 Wrap(__m128 p) {
+        return _mm_sub_ps(p, _mm_cvtepi32_ps(_mm_cvttps_epi32(p)));
+    }
+
+    // sin(2 pi p): fold to a quarter cycle, then a 7th order odd polynomial (error < 2e-4)
+    inline __m128 SineShape(__m128 p) {
+        __m128 half = _mm_set1_ps(0.5f);
+        __m128 t = _mm_sub_ps(p, half);                   // [-0.5, 0.5), sin(2 pi p) = -sin(2 pi t)
+        __m128 signBit = _mm_andnot_ps(_mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)), t);
+        __m128 a = Abs(t);
+        __m128 folded = _mm_min_ps(a, _mm_sub_ps(half, a)); // sin(pi - x) = sin(x)
+        __m128 y = _mm_mul_ps(folded, _mm_set1_ps(6.28318530718f));
+        __m128 y2 = _mm_mul_ps(y, y);
+        __m128 poly = _mm_add_ps(_mm_set1_ps(1.0f / 120.0f), _mm_mul_ps(y2, _mm_set1_ps(-1.0f / 5040.0f)));
+        poly = _mm_add_ps(_mm_set1_ps(-1.0f / 6.0f), _mm_mul_ps(y2, poly));
+        poly = _mm_add_ps(_mm_set1_ps(1.0f), _mm_mul_ps(y2, poly));
+        __m128 s = _mm_mul_ps(y, poly);
+        return _mm_xor_ps(_mm_xor_ps(s, signBit), _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000)));
+    }
+
+    // Triangle in phase with the sine: 0 at p = 0, peak at p = 0.25
+    inline __m128 TriangleShape(__m128 p) {
+        __m128 q = Wrap(_mm_add_ps(p, _mm_set1_ps(0.75f)));
+        return _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(4.0f), Abs(_mm_sub_ps(q, _mm_set1_ps(0.5f)))), _mm_set1_ps(1.0f));
+    }
+
+    inline __m128 SquareShape(__m128 p) {
+        __m128 firstHalf = _mm_cmplt_ps(p, _mm_set1_ps(0.5f));
+        __m128 one = _mm_set1_ps(1.0f);
+        return _mm_or_ps(_mm_and_ps(firstHalf, one), _mm_andnot_ps(firstHalf, _mm_set1_ps(-1.0f)));
+    }
+}
+
+void Lfo::configure(int rate) {
+    sampleRate = std::max(8000, rate);
+}
+
+void Lfo::reset() {
+    phase = 0.0;
+    randomFrom = 0.0f;
+    randomTo = nextRandom();
+}
+
+// xorshift32 mapped to [-1, 1)
+float Lfo::nextRandom() {
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return (float)(randomState >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+void Lfo::render(float* out, int frames) {
+    if (!out || frames <= 0) return;
+
+    const double increment = std::max(0.0f, rateHz) / sampleRate;
+    const __m128 laneOffsets = _mm_mul_ps(_mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f), _mm_set1_ps((float)increment));
+
+    for (int i = 0; i < frames; i += 4) {
+        int count = std::min(4, frames - i);
+        __m128 p = Wrap(_mm_add_ps(_mm_set1_ps((float)phase), laneOffsets));
+        __m128 value;
+
+        if (shape == LfoShape::Random && phase + 3.0 * increment >= 1.0) {
+            // A cycle boundary falls inside this vector: step the lanes one by one
+            float lanes[4];
+            for (int n = 0; n < 4; n++) {
+                lanes[n] = randomFrom + (float)phase * (randomTo - randomFrom);
+                if (n < count) {
+                    phase += increment;
+                    if (phase >= 1.0) {
+                        phase -= floor(phase);
+                        randomFrom = randomTo;
+                        randomTo = nextRandom();
+                    }
+                }
+            }
+            value = _mm_loadu_ps(lanes);
+        }
+        else {
+            switch (shape) {
+            case LfoShape::Random:
+                value = _mm_add_ps(_mm_set1_ps(randomFrom), _mm_mul_ps(p, _mm_set1_ps(randomTo - randomFrom)));
+                break;
+            case LfoShape::Triangle:
+                value = TriangleShape(p);
+                break;
+            case LfoShape::Square:
+                value = SquareShape(p);
+                break;
+            default:
+                value = SineShape(p);
+                break;
+            }
+
+            phase += count * increment;
+            if (phase >= 1.0) {
+                phase -= floor(phase);
+                if (shape == LfoShape::Random) {
+                    randomFrom = randomTo;
+                    randomTo = nextRandom();
+                }
+            }
+        }
+
+        if (count == 4) {
+            _mm_storeu_ps(out + i, value);
+        }
+        else {
+            float lanes[4];
+            _mm_storeu_ps(lanes, value);
+            for (int n = 0; n < count; n++) out[i + n] = lanes[n];
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+// LFO waveforms, in the order shown in the UI
+enum class LfoShape : int {
+    Sine = 0,
+    Triangle,
+    Square,
+    Random,     // New random target every cycle, linear glide between them
+    Count
+};
+
+// Lfo - phase-accumulator low frequency oscillator driven by the audio sample clock.
+//
+// The phase advances by rate / sampleRate per rendered frame, so modulation keeps
+// running (and stays smooth) regardless of what the UI thread is doing. render()
+// produces one control value in [-1, 1] per frame, four at a time in SSE: sine is
+// a folded odd polynomial, triangle and square are built from the phase directly.
+// Random draws a new target at every cycle boundary and glides to it.
+class Lfo {
+public:
+    static const char* const NAMES[(int)LfoShape::Count];
+
+    Lfo() = default;
+
+    void configure(int sampleRate);
+    void setShape(LfoShape newShape) { shape = newShape; }
+    void setRate(float hz) { rateHz = hz; }
+
+    // Restart the cycle (phase 0, sine/triangle at zero rising)
+    void reset();
+
+    // Write the next `frames` control values into out
+    void render(float* out, int frames);
+
+private:
+    LfoShape shape = LfoShape::Sine;
+    float rateHz = 1.0f;
+    int sampleRate = 48000;
+
+    double phase = 0.0;           // [0, 1)
+
+    // Random shape state
+    unsigned int randomState = 0x9E3779B9u;
+    float randomFrom = 0.0f;
+    float randomTo = 0.0f;
+
+    float nextRandom();
+};
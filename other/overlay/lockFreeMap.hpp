@@ -0,0 +1,204 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <thread>
+
+// LockFreePointerMap - fixed-capacity map from a pointer key to an object from its own pool.
+//
+// Open addressing with linear probing over atomic slots, so lookups on the audio
+// path never take a lock. Keys are claimed with a CAS; removed slots become
+// tombstones that later inserts can reuse. The one rule callers must follow is a
+// single writer per key: the same key is never inserted from two threads at once,
+// which holds for Opus encoders since each one is driven by one thread at a time.
+//
+// Values live in a pool of Capacity objects built together with the map, so nothing
+// is allocated or freed after construction: an insert takes a free pool entry and
+// rebuilds it in place (Value's constructor must not allocate either), a removed
+// entry goes back to the pool. Maps are large, keep them in statics.
+//
+// Entries unused for a while can be evicted. An evicted value isn't recycled right
+// away, it is retired and only returned to the pool on a later eviction pass once
+// it has been out of the table for a full grace period, so a thread that looked it
+// up just before the eviction can finish its frame safely. Retired values count
+// against the pool until then.
+template<typename Value, int Capacity>
+class LockFreePointerMap {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    LockFreePointerMap() = default;
+    LockFreePointerMap(const LockFreePointerMap&) = delete;
+    LockFreePointerMap& operator=(const LockFreePointerMap&) = delete;
+
+    // Value for key, nullptr when missing. Marks the entry as used at `now`.
+    Value* find(const void* key, uint64_t now) {
+        uintptr_t k = reinterpret_cast<uintptr_t>(key);
+        for (int n = 0, i = home(k); n < Capacity; n++, i = (i + 1) & (Capacity - 1)) {
+            uintptr_t current = slots[i].key.load(std::memory_order_acquire);
+            if (current == EMPTY) return nullptr;
+            if (current != k) continue;
+
+            // Touch before reading the value so a concurrent eviction either sees the
+            // fresh timestamp or has already cleared the value
+            slots[i].lastUsed.store(now, std::memory_order_seq_cst);
+            Value* value = slots[i].value.load(std::memory_order_seq_cst);
+
+            // A cleared value with the key still in place is an eviction or erase that
+            // hasn't decided yet. Wait for the value to come back or the key to go,
+            // reporting it missing now would let findOrInsert give the key a second slot.
+            while (!value && slots[i].key.load(std::memory_order_seq_cst) == k) {
+                std::this_thread::yield();
+                value = slots[i].value.load(std::memory_order_seq_cst);
+            }
+            if (value) return value;
+        }
+        return nullptr;
+    }
+
+    // Value for key, a freshly constructed pool entry when the key is new. nullptr if the
+    // table or the pool is full.
+    Value* findOrInsert(const void* key, uint64_t now) {
+        if (Value* existing = find(key, now)) return existing;
+
+        uintptr_t k = reinterpret_cast<uintptr_t>(key);
+        for (int n = 0, i = home(k); n < Capacity; n++, i = (i + 1) & (Capacity - 1)) {
+            uintptr_t current = slots[i].key.load(std::memory_order_acquire);
+            if (current != EMPTY && current != TOMBSTONE) continue;
+            if (!slots[i].key.compare_exchange_strong(current, k, std::memory_order_acq_rel)) continue;
+
+            Value* value = takeFromPool();
+            if (!value) {
+                slots[i].key.store(TOMBSTONE, std::memory_order_release);
+                return nullptr;
+            }
+            slots[i].lastUsed.store(now, std::memory_order_relaxed);
+            slots[i].value.store(value, std::memory_order_seq_cst);
+            count.fetch_add(1, std::memory_order_relaxed);
+            return value;
+        }
+        return nullptr;
+    }
+
+    // Remove key and return its value to the pool right away. Only for the key's own
+    // thread, which is done with the value. false if missing.
+    bool erase(const void* key) {
+        uintptr_t k = reinterpret_cast<uintptr_t>(key);
+        for (int n = 0, i = home(k); n < Capacity; n++, i = (i + 1) & (Capacity - 1)) {
+            uintptr_t current = slots[i].key.load(std::memory_order_acquire);
+            if (current == EMPTY) return false;
+            if (current != k) continue;
+
+            Value* value = slots[i].value.exchange(nullptr, std::memory_order_seq_cst);
+            if (!value) continue;
+            slots[i].key.store(TOMBSTONE, std::memory_order_release);
+            count.fetch_sub(1, std::memory_order_relaxed);
+            returnToPool(value);
+            return true;
+        }
+        return false;
+    }
+
+    // Retire entries idle for longer than maxIdle and recycle values retired more than
+    // maxIdle ago. Only one thread evicts at a time, others return immediately.
+    void evictStale(uint64_t now, uint64_t maxIdle) {
+        if (evicting.test_and_set(std::memory_order_acquire)) return;
+
+        for (int i = 0; i < Capacity; i++) {
+            if (retired[i] && now - retiredAt[i] > maxIdle) {
+                returnToPool(retired[i]);
+                retired[i] = nullptr;
+            }
+        }
+
+        for (int i = 0; i < Capacity; i++) {
+            uintptr_t current = slots[i].key.load(std::memory_order_acquire);
+            if (current == EMPTY || current == TOMBSTONE) continue;
+            if (now - slots[i].lastUsed.load(std::memory_order_relaxed) <= maxIdle) continue;
+
+            Value* value = slots[i].value.exchange(nullptr, std::memory_order_seq_cst);
+            if (!value) continue;
+
+            // The owner touched it in the meantime: put it back
+            if (now - slots[i].lastUsed.load(std::memory_order_seq_cst) <= maxIdle) {
+                slots[i].value.store(value, std::memory_order_seq_cst);
+                continue;
+            }
+
+            slots[i].key.store(TOMBSTONE, std::memory_order_release);
+            count.fetch_sub(1, std::memory_order_relaxed);
+            retire(value, now);
+        }
+
+        evicting.clear(std::memory_order_release);
+    }
+
+    // Number of live entries, safe to read from any thread
+    int size() const { return count.load(std::memory_order_relaxed); }
+
+    // Call fn(slot, value) for every live entry. A slot keeps its index for as long as
+    // its key stays in the table, and values stay valid through the eviction grace
+    // period, the same as a find() result.
+    template<typename Fn>
+    void forEach(Fn fn) {
+        for (int i = 0; i < Capacity; i++) {
+            Value* value = slots[i].value.load(std::memory_order_acquire);
+            if (value) fn(i, value);
+        }
+    }
+
+private:
+    static constexpr uintptr_t EMPTY = 0;
+    static constexpr uintptr_t TOMBSTONE = 1;
+
+    struct Slot {
+        std::atomic<uintptr_t> key{ EMPTY };
+        std::atomic<Value*> value{ nullptr };
+        std::atomic<uint64_t> lastUsed{ 0 };
+    };
+
+    Slot slots[Capacity];
+    std::atomic<int> count{ 0 };
+
+    // Every value the map will ever hand out, and which of them are in use
+    Value pool[Capacity];
+    std::atomic<bool> taken[Capacity] = {};
+
+    // Evicted values waiting out their grace period, only touched while `evicting` is held
+    Value* retired[Capacity] = {};
+    uint64_t retiredAt[Capacity] = {};
+    std::atomic_flag evicting = ATOMIC_FLAG_INIT;
+
+    // Fibonacci hashing of the pointer, low bits are alignment
+    static int home(uintptr_t k) {
+        return (int)(((uint64_t)(k >> 4) * 0x9E3779B97F4A7C15ull) >> 40) & (Capacity - 1);
+    }
+
+    // Claim a free pool entry and reset it to a default-constructed value
+    Value* takeFromPool() {
+        for (int i = 0; i < Capacity; i++) {
+            if (taken[i].load(std::memory_order_relaxed)) continue;
+            if (taken[i].exchange(true, std::memory_order_acquire)) continue;
+
+            pool[i].~Value();
+            return new (&pool[i]) Value();
+        }
+        return nullptr;
+    }
+
+    void returnToPool(Value* value) {
+        taken[value - pool].store(false, std::memory_order_release);
+    }
+
+    // Live and retired values together never exceed the pool, so a retire slot is
+    // always free
+    void retire(Value* value, uint64_t now) {
+        for (int i = 0; i < Capacity; i++) {
+            if (!retired[i]) {
+                retired[i] = value;
+                retiredAt[i] = now;
+                return;
+            }
+        }
+    }
+};
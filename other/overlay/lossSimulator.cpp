@@ -0,0 +1,73 @@
+#include "lossSimulator.hpp"
+#include <algorithm> // For std::max
+#include <cmath>     // For logf
+
+const GilbertElliottModel LOSS_MODELS[LOSS_MODEL_COUNT] = {
+    // name            good->bad  bad->good  loss good  loss bad  reorder
+    { "Random 2%",     0.0f,      1.0f,      0.02f,     0.0f,     0.0f  },
+    { "Bursty 5%",     0.02f,     0.35f,     0.005f,    0.8f,     0.01f },
+    { "Bursty 10%",    0.04f,     0.3f,      0.01f,     0.8f,     0.02f },
+    { "Mobile 20%",    0.08f,     0.25f,     0.02f,     0.75f,    0.05f },
+};
+
+const JitterModel JITTER_MODELS[JITTER_MODEL_COUNT] = {
+    // name          jitter   spike chance  spike    loss model
+    { "Wired",       1.0f,    0.0f,         0.0f,    -1 },
+    { "Wi-Fi",       4.0f,    0.005f,       80.0f,   0  },
+    { "Congested",   10.0f,   0.01f,        150.0f,  1  },
+    { "Mobile",      20.0f,   0.005f,       300.0f,  2  },
+};
+
+float GilbertElliottModel::expectedLoss() const {
+    // Stationary share of time in the bad state
+    float total = goodToBad + badToGood;
+    float badShare = total > 0.0f ? goodToBad / total : 0.0f;
+    return (1.0f - badShare) * lossInGood + badShare * lossInBad;
+}
+
+void PacketLossSimulator::configure(const GilbertElliottModel& newModel, unsigned int seed) {
+    model = newModel;
+    state = seed ? seed : 1;
+    bad = false;
+}
+
+// xorshift32 mapped to [0, 1)
+float PacketLossSimulator::nextUniform() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (float)(state >> 8) * (1.0f / 16777216.0f);
+}
+
+PacketFate PacketLossSimulator::next() {
+    bad = bad ? nextUniform() >= model.badToGood : nextUniform() < model.goodToBad;
+
+    PacketFate fate;
+    fate.lost = nextUniform() < (bad ? model.lossInBad : model.lossInGood);
+    fate.late = !fate.lost && nextUniform() < model.reorder;
+    return fate;
+}
+
+void JitterSimulator::configure(const JitterModel& newModel, unsigned int seed) {
+    model = newModel;
+    state = seed ? seed : 1;
+    spike = 0.0f;
+}
+
+float JitterSimulator::nextUniform() {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (float)(state >> 8) * (1.0f / 16777216.0f);
+}
+
+float JitterSimulator::next(float intervalMs) {
+    // The queue drains while the packet was on its way
+    spike = std::max(0.0f, spike - intervalMs);
+    if (nextUniform() < model.spikeChance) {
+        spike = std::max(spike, model.spikeMs);
+    }
+
+    float jitter = -model.jitterMs * logf(1.0f - nextUniform());
+    return PATH_DELAY_MS + jitter + spike;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+// Two-state Gilbert-Elliott channel. In the good state packets are lost with a
+// small probability, in the bad state with a large one; the transition
+// probabilities set how long bursts last. Reorder is the chance a packet that
+// does arrive comes in one slot late, behind its successor.
+struct GilbertElliottModel {
+    const char* name;
+    float goodToBad;    // P(good -> bad) per packet
+    float badToGood;    // P(bad -> good) per packet, mean burst length is 1 / badToGood
+    float lossInGood;
+    float lossInBad;
+    float reorder;
+
+    // Long-run loss rate
+    float expectedLoss() const;
+};
+
+// Channel models the FEC benchmark runs through, from clean Wi-Fi to a bad mobile link
+static constexpr int LOSS_MODEL_COUNT = 4;
+extern const GilbertElliottModel LOSS_MODELS[LOSS_MODEL_COUNT];
+
+// What happened to one packet
+struct PacketFate {
+    bool lost = false;
+    bool late = false;  // Arrived, but after the next packet
+};
+
+// PacketLossSimulator - deterministic packet fates drawn from a Gilbert-Elliott model.
+//
+// The same model and seed always give the same sequence, so two encodings of the
+// same audio (FEC on and off) can be put through identical losses.
+class PacketLossSimulator {
+public:
+    PacketLossSimulator() = default;
+
+    void configure(const GilbertElliottModel& model, unsigned int seed);
+
+    PacketFate next();
+
+private:
+    GilbertElliottModel model = {};
+    unsigned int state = 1;
+    bool bad = false;
+
+    float nextUniform();
+};
+
+// Network delay for the jitter buffer benchmark. Every packet gets an exponentially
+// distributed jitter on top of a fixed path delay; now and then a spike (a Wi-Fi
+// scan, a queue filling up) holds packets back, and the queue then drains at the
+// packet rate, so the held packets arrive in a burst. lossModel picks one of
+// LOSS_MODELS to lose packets through as well, -1 for none.
+struct JitterModel {
+    const char* name;
+    float jitterMs;     // Mean of the exponential jitter
+    float spikeChance;  // P(spike) per packet
+    float spikeMs;      // Delay added by a spike, drains by one packet interval per packet
+    int lossModel;
+};
+
+// Delay traces the jitter buffer benchmark runs through
+static constexpr int JITTER_MODEL_COUNT = 4;
+extern const JitterModel JITTER_MODELS[JITTER_MODEL_COUNT];
+
+// JitterSimulator - deterministic per-packet network delays drawn from a JitterModel.
+class JitterSimulator {
+public:
+    static constexpr float PATH_DELAY_MS = 30.0f;  // Fixed part of every delay
+
+    JitterSimulator() = default;
+
+    void configure(const JitterModel& model, unsigned int seed);
+
+    // One-way delay in ms of the next packet, sent intervalMs after the previous one
+    float next(float intervalMs);
+
+private:
+    JitterModel model = {};
+    unsigned int state = 1;
+    float spike = 0.0f;     // What's left of the current spike
+
+    float nextUniform();
+};
@@ -0,0 +1,189 @@
+#include "loudnessMeter.hpp"
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For tan, pow, log10
+
+namespace {
+    // Mean square -> LUFS (BS.1770 offset), with a floor for silence
+    inline float EnergyToLufs(double energy) {
+        if (energy <= 1e-12) return LoudnessMeter::SILENCE_LUFS;
+        return (float)(-0.691 + 10.0 * log10(energy));
+    }
+}
+
+// K-weighting filters for the given sample rate, from the analog prototypes
+// BS.1770 specifies at 48 kHz
+void KWeightingFilter::design(int sampleRate) {
+    const double pi = 3.14159265358979323846;
+
+    // Stage 1: high shelf, +4 dB above ~1.7 kHz (head diffraction)
+    double f0 = 1681.974450955533;
+    double gainDb = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = tan(pi * f0 / sampleRate);
+    double vh = pow(10.0, gainDb / 20.0);
+    double vb = pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+
+    shelf.b0 = (vh + vb * k / q + k * k) / a0;
+    shelf.b1 = 2.0 * (k * k - vh) / a0;
+    shelf.b2 = (vh - vb * k / q + k * k) / a0;
+    shelf.a1 = 2.0 * (k * k - 1.0) / a0;
+    shelf.a2 = (1.0 - k / q + k * k) / a0;
+
+    // Stage 2: RLB high-pass at ~38 Hz
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = tan(pi * f0 / sampleRate);
+    a0 = 1.0 + k / q + k * k;
+
+    highPass.b0 = 1.0;
+    highPass.b1 = -2.0;
+    highPass.b2 = 1.0;
+    highPass.a1 = 2.0 * (k * k - 1.0) / a0;
+    highPass.a2 = (1.0 - k / q + k * k) / a0;
+
+    reset();
+}
+
+void KWeightingFilter::reset() {
+    shelf.z1 = shelf.z2 = 0.0;
+    highPass.z1 = highPass.z2 = 0.0;
+}
+
+void LoudnessMeter::configure(int rate, int numChannels) {
+    rate = std::max(8000, rate);
+    numChannels = std::max(1, std::min(numChannels, MAX_CHANNELS));
+    if (rate == sampleRate && numChannels == channels) return;
+
+    sampleRate = rate;
+    channels = numChannels;
+    subBlockLength = sampleRate / 10;
+
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+        weighting[ch].design(sampleRate);
+    }
+    reset();
+}
+
+void LoudnessMeter::reset() {
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+        weighting[ch].reset();
+    }
+
+    subBlockSum = 0.0;
+    subBlockFill = 0;
+
+    for (int i = 0; i < SHORT_TERM_BLOCKS; i++) {
+        subBlockEnergy[i] = 0.0;
+    }
+    subBlockPos = 0;
+    subBlocksSeen = 0;
+    momentarySum = 0.0;
+    shortTermSum = 0.0;
+
+    for (int i = 0; i < HISTOGRAM_BINS; i++) {
+        histogramEnergy[i] = 0.0;
+        histogramCount[i] = 0;
+    }
+
+    momentaryLufs.store(SILENCE_LUFS, std::memory_order_relaxed);
+    shortTermLufs.store(SILENCE_LUFS, std::memory_order_relaxed);
+    integratedLufs.store(SILENCE_LUFS, std::memory_order_relaxed);
+}
+
+void LoudnessMeter::process(const float* buffer, int frames) {
+    if (!buffer || frames <= 0 || channels <= 0) return;
+
+    if (resetRequested.exchange(false, std::memory_order_relaxed)) {
+        reset();
+    }
+
+    for (int i = 0; i < frames; i++) {
+        // Channel weights are 1.0 for left/right
+        for (int ch = 0; ch < channels; ch++) {
+            double weighted = weighting[ch].process(buffer[i * channels + ch]);
+            subBlockSum += weighted * weighted;
+        }
+
+        if (++subBlockFill >= subBlockLength) {
+            finishSubBlock();
+        }
+    }
+}
+
+void LoudnessMeter::addSilence(int frames) {
+    if (frames <= 0 || channels <= 0) return;
+
+    if (resetRequested.exchange(false, std::memory_order_relaxed)) {
+        reset();
+    }
+
+    // Only the sub-block position moves, no energy is added
+    while (frames > 0) {
+        int step = std::min(frames, subBlockLength - subBlockFill);
+        subBlockFill += step;
+        frames -= step;
+
+        if (subBlockFill >= subBlockLength) {
+            finishSubBlock();
+        }
+    }
+}
+
+void LoudnessMeter::finishSubBlock() {
+    double energy = subBlockSum / subBlockLength;
+    subBlockSum = 0.0;
+    subBlockFill = 0;
+
+    // Running sums: add the new sub-block, drop the ones leaving each window
+    int momentaryOut = (subBlockPos - MOMENTARY_BLOCKS + SHORT_TERM_BLOCKS) % SHORT_TERM_BLOCKS;
+    momentarySum += energy - subBlockEnergy[momentaryOut];
+    shortTermSum += energy - subBlockEnergy[subBlockPos];
+    subBlockEnergy[subBlockPos] = energy;
+    subBlockPos = (subBlockPos + 1) % SHORT_TERM_BLOCKS;
+    subBlocksSeen++;
+
+    // Rounding can leave tiny negative residues in the running sums
+    momentarySum = std::max(0.0, momentarySum);
+    shortTermSum = std::max(0.0, shortTermSum);
+
+    double momentaryEnergy = momentarySum / MOMENTARY_BLOCKS;
+    momentaryLufs.store(EnergyToLufs(momentaryEnergy), std::memory_order_relaxed);
+    shortTermLufs.store(EnergyToLufs(shortTermSum / SHORT_TERM_BLOCKS), std::memory_order_relaxed);
+
+    // Every sub-block completes a new 400 ms gating block (75% overlap)
+    if (subBlocksSeen >= MOMENTARY_BLOCKS) {
+        float blockLufs = EnergyToLufs(momentaryEnergy);
+        if (blockLufs >= HISTOGRAM_MIN_LUFS) {
+            int bin = std::min((int)((blockLufs - HISTOGRAM_MIN_LUFS) / HISTOGRAM_STEP), HISTOGRAM_BINS - 1);
+            histogramEnergy[bin] += momentaryEnergy;
+            histogramCount[bin]++;
+        }
+        integratedLufs.store(computeIntegrated(), std::memory_order_relaxed);
+    }
+}
+
+float LoudnessMeter::computeIntegrated() const {
+    // Absolute gate: everything in the histogram is already above -70 LUFS
+    double totalEnergy = 0.0;
+    unsigned int totalCount = 0;
+    for (int i = 0; i < HISTOGRAM_BINS; i++) {
+        totalEnergy += histogramEnergy[i];
+        totalCount += histogramCount[i];
+    }
+    if (totalCount == 0) return SILENCE_LUFS;
+
+    // Relative gate: 10 LU below the loudness of the absolute-gated blocks
+    double relativeGate = EnergyToLufs(totalEnergy / totalCount) - 10.0;
+    int firstBin = std::max(0, (int)ceil((relativeGate - HISTOGRAM_MIN_LUFS) / HISTOGRAM_STEP));
+
+    double gatedEnergy = 0.0;
+    unsigned int gatedCount = 0;
+    for (int i = firstBin; i < HISTOGRAM_BINS; i++) {
+        gatedEnergy += histogramEnergy[i];
+        gatedCount += histogramCount[i];
+    }
+    if (gatedCount == 0) return SILENCE_LUFS;
+
+    return EnergyToLufs(gatedEnergy / gatedCount);
+}
@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+
+// BS.1770 K-weighting for one channel: high shelf (+4 dB above ~1.7 kHz) followed
+// by the RLB high-pass (~38 Hz), designed for any sample rate
+class KWeightingFilter {
+public:
+    void design(int sampleRate);
+    void reset();
+
+    inline double process(double x) {
+        return highPass.process(shelf.process(x));
+    }
+
+private:
+    struct Biquad {
+        double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+        double z1 = 0.0, z2 = 0.0;
+
+        inline double process(double x) {
+            double y = b0 * x + z1;
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+            return y;
+        }
+    };
+
+    Biquad shelf;
+    Biquad highPass;
+};
+
+// LoudnessMeter - streaming ITU-R BS.1770-4 / EBU R128 loudness meter.
+//
+// Audio is K-weighted (pre-filter shelf + RLB high-pass, designed for the actual
+// sample rate) and squared into 100 ms sub-blocks. Momentary (400 ms) and
+// short-term (3 s) loudness are running sums over a ring of sub-block energies.
+// Integrated loudness uses the 400 ms / 75% overlap gating blocks collected in a
+// 0.1 LU histogram, so the absolute (-70 LUFS) and relative (-10 LU) gates never
+// need the block history. Work is O(1) per sample, the histogram is only walked
+// once per sub-block. Results are published through atomics for the UI thread.
+class LoudnessMeter {
+public:
+    static constexpr int MAX_CHANNELS = 2;
+    static constexpr float SILENCE_LUFS = -120.0f; // Published when there is no signal
+
+    LoudnessMeter() = default;
+
+    // Set format, resets all measurements when it changes
+    void configure(int sampleRate, int numChannels);
+
+    // Clear every measurement (call from the audio thread)
+    void reset();
+
+    // Ask the audio thread to reset on its next block (call from any thread)
+    void requestReset() { resetRequested.store(true, std::memory_order_relaxed); }
+
+    // Measure a block of interleaved audio
+    void process(const float* buffer, int frames);
+
+    // Account for frames that were not processed because they were silent
+    void addSilence(int frames);
+
+    // Latest values in LUFS, safe to read from any thread
+    float getMomentary() const { return momentaryLufs.load(std::memory_order_relaxed); }
+    float getShortTerm() const { return shortTermLufs.load(std::memory_order_relaxed); }
+    float getIntegrated() const { return integratedLufs.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int MOMENTARY_BLOCKS = 4;   // 400 ms of 100 ms sub-blocks
+    static constexpr int SHORT_TERM_BLOCKS = 30; // 3 s of 100 ms sub-blocks
+    static constexpr float HISTOGRAM_MIN_LUFS = -70.0f;
+    static constexpr float HISTOGRAM_MAX_LUFS = 5.0f;
+    static constexpr float HISTOGRAM_STEP = 0.1f;
+    static constexpr int HISTOGRAM_BINS = (int)((HISTOGRAM_MAX_LUFS - HISTOGRAM_MIN_LUFS) / HISTOGRAM_STEP) + 1;
+
+    KWeightingFilter weighting[MAX_CHANNELS];
+
+    // Current 100 ms sub-block
+    double subBlockSum = 0.0;
+    int subBlockFill = 0;
+    int subBlockLength = 4800;
+
+    // Mean square of the last SHORT_TERM_BLOCKS sub-blocks, with running sums
+    double subBlockEnergy[SHORT_TERM_BLOCKS] = {};
+    int subBlockPos = 0;
+    int subBlocksSeen = 0;
+    double momentarySum = 0.0;
+    double shortTermSum = 0.0;
+
+    // Gating block histogram for integrated loudness (energy sums and counts per 0.1 LU)
+    double histogramEnergy[HISTOGRAM_BINS] = {};
+    unsigned int histogramCount[HISTOGRAM_BINS] = {};
+
+    int sampleRate = 0;
+    int channels = 0;
+
+    std::atomic<bool> resetRequested{ false };
+    std::atomic<float> momentaryLufs{ SILENCE_LUFS };
+    std::atomic<float> shortTermLufs{ SILENCE_LUFS };
+    std::atomic<float> integratedLufs{ SILENCE_LUFS };
+
+    void finishSubBlock();
+    float computeIntegrated() const;
+};
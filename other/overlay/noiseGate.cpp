@@ -0,0 +1,76 @@
+#include "noiseGate.hpp"
+#include <algorithm> // For std::min, std::max
+
+void NoiseGate::configure(int rate) {
+    rate = std::max(8000, rate);
+    if (rate == sampleRate) return;
+
+    sampleRate = rate;
+    updateTimes();
+}
+
+void NoiseGate::setParams(float newOpenDb, float newCloseDb, float hold, float attack, float release) {
+    openDb = newOpenDb;
+    closeDb = std::min(newCloseDb, newOpenDb);
+
+    if (hold == holdMs && attack == attackMs && release == releaseMs) return;
+    holdMs = hold;
+    attackMs = attack;
+    releaseMs = release;
+    updateTimes();
+}
+
+void NoiseGate::updateTimes() {
+    if (sampleRate <= 0 || holdMs < 0.0f) return;
+
+    holdFrames = (int)(holdMs * sampleRate / 1000.0f);
+    attackStep = 1.0f / std::max(1.0f, attackMs * sampleRate / 1000.0f);
+    releaseStep = 1.0f / std::max(1.0f, releaseMs * sampleRate / 1000.0f);
+}
+
+void NoiseGate::reset() {
+    open = false;
+    holdRemaining = 0;
+    gain = 0.0f;
+    publishedOpen.store(false, std::memory_order_relaxed);
+}
+
+void NoiseGate::update(float levelDb, int frames) {
+    if (levelDb >= openDb) {
+        open = true;
+        holdRemaining = holdFrames;
+    }
+    else if (open) {
+        // Between the thresholds the gate stays open and the hold is refreshed,
+        // below the close threshold the hold runs down before the release starts
+        if (levelDb >= closeDb) {
+            holdRemaining = holdFrames;
+        }
+        else if (holdRemaining > 0) {
+            holdRemaining -= frames;
+        }
+        else {
+            open = false;
+        }
+    }
+
+    publishedOpen.store(open, std::memory_order_relaxed);
+}
+
+void NoiseGate::apply(float* buffer, int frames, int channels) {
+    if (!buffer || frames <= 0 || channels <= 0) return;
+
+    float target = open ? 1.0f : 0.0f;
+
+    // Settled fully open: nothing to do
+    if (gain == target && open) return;
+
+    float step = open ? attackStep : -releaseStep;
+    for (int i = 0; i < frames; i++) {
+        gain = std::max(0.0f, std::min(1.0f, gain + step));
+        float* frame = buffer + i * channels;
+        for (int ch = 0; ch < channels; ch++) {
+            frame[ch] *= gain;
+        }
+    }
+}
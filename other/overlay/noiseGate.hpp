@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+
+// NoiseGate - frame-level gate with hysteresis, hold and gain ramps.
+//
+// The gate opens when a frame reaches the open threshold and only starts closing
+// once the level has stayed under the (lower) close threshold for the hold time,
+// so borderline frames don't flap between open and closed. Opening and closing
+// are linear gain ramps over the attack/release times, applied per sample. Once
+// the release ramp has reached zero the gate reports silence and the caller can
+// skip the effect chain entirely (and let Opus DTX take over).
+class NoiseGate {
+public:
+    NoiseGate() = default;
+
+    // Set the sample rate used for the hold and ramp times
+    void configure(int sampleRate);
+
+    // Thresholds in dBFS (close is forced to be at or below open) and times in ms
+    void setParams(float openDb, float closeDb, float holdMs, float attackMs, float releaseMs);
+
+    void reset();
+
+    // Feed the level of the next frame, call once per frame before apply()
+    void update(float levelDb, int frames);
+
+    // Apply the gate gain to a frame of interleaved audio in place
+    void apply(float* buffer, int frames, int channels);
+
+    // Fully closed: nothing left to fade out, the frame can be treated as silence
+    bool isSilent() const { return !open && gain <= 0.0f; }
+
+    // Gate state for the UI, safe to read from any thread
+    bool isOpen() const { return publishedOpen.load(std::memory_order_relaxed); }
+
+private:
+    float openDb = -55.0f;
+    float closeDb = -61.0f;
+    int holdFrames = 0;
+    float attackStep = 1.0f;   // Gain change per frame while opening
+    float releaseStep = 1.0f;  // Gain change per frame while closing
+
+    float holdMs = -1.0f;
+    float attackMs = -1.0f;
+    float releaseMs = -1.0f;
+    int sampleRate = 0;
+
+    bool open = false;
+    int holdRemaining = 0;
+    float gain = 0.0f;
+
+    std::atomic<bool> publishedOpen{ false };
+
+    void updateTimes();
+};
@@ -1,6 +1,25 @@
 #include "overlay.hpp"
+#include "tailTracker.hpp"
+#include "cpuFeatures.hpp"
+#include "peakLimiter.hpp"
+#include "truePeak.hpp"
+#include "loudnessMeter.hpp"
+#include "autoGain.hpp"
+#include "saturator.hpp"
+#include "compressor.hpp"
+#include "noiseGate.hpp"
+#include "lfo.hpp"
+#include "lockFreeMap.hpp"
+#include "encoderCtlCache.hpp"
+#include "benchmarks.hpp"
+#include "complexityController.hpp"
+#include "channelLayout.hpp"
+#include "packetRecorder.hpp"
+#include "comfortNoise.hpp"
+#include "streamMixer.hpp"
 #include "other/configs/globals.h"
 #include "libraries/opus/include/opus.h"
+#include "libraries/opus/include/opus_multistream.h"
 #include <Windows.h>
 #include <iostream>
 #include <algorithm> // For std::min, std::max
@@ -13,6 +32,7 @@
 #include <chrono>
 #include <dwmapi.h>
 #include <map> // Added for std::map
+#include <atomic>
 
 // Function declarations
 std::string GetProcessName();
@@ -53,9 +73,48 @@ float reverbSize = 0.7f;       // Room size (0.0 to 1.0)
 float reverbDamping = 0.5f;    // High frequency damping (0.0 to 1.0)
 float reverbWidth = 1.0f;      // Stereo width (0.0 to 1.0)
 bool reverbEnabled = false;    // Toggle for reverb effect
+bool reverbHalfPrecision = false; // Store reverb delay lines as FP16 (needs F16C)
 bool rgbModeEnabled = false;   // Toggle for RGB color picker mode
 float rgbCycleSpeed = 0.5f;    // Speed of RGB color cycling
 bool bassBoostEnabled = false; // Toggle for extra bass boost effect
+float limiterLookaheadMs = 2.0f; // Output limiter look-ahead (1 to 5 ms)
+bool agcEnabled = false;       // Loudness-targeting auto gain instead of the gain sliders
+float agcTargetLufs = -16.0f;  // Auto gain target loudness
+float agcAttackMs = 50.0f;     // Auto gain attack (gain going down)
+float agcReleaseMs = 800.0f;   // Auto gain release (gain going up)
+float agcHoldMs = 300.0f;      // Auto gain hold after every reduction
+int saturatorType = (int)SaturatorType::Tanh; // Soft clipper curve for the EQ and energy stages
+bool compEnabled = false;      // Compressor after the gain stage
+float compThresholdDb = -18.0f; // Compressor threshold (dBFS)
+float compRatio = 4.0f;        // Compressor ratio (x:1)
+float compKneeDb = 6.0f;       // Compressor soft knee width
+float compAttackMs = 5.0f;     // Compressor attack
+float compReleaseMs = 120.0f;  // Compressor release
+float compMakeupDb = 0.0f;     // Compressor makeup gain
+bool compLinked = true;        // One gain for both channels instead of one per channel
+float gateOpenDb = -55.0f;     // Noise gate opens at this level (dBFS)
+float gateCloseDb = -61.0f;    // Noise gate starts closing below this level (dBFS)
+float gateHoldMs = 200.0f;     // Noise gate hold before closing
+float gateAttackMs = 2.0f;     // Noise gate fade-in
+float gateReleaseMs = 80.0f;   // Noise gate fade-out
+bool gateDtxEnabled = true;    // Send closed-gate frames as Opus DTX instead of comfort noise
+int energyLfoShape = (int)LfoShape::Sine; // Energy effect modulation waveform
+float energyLfoRate = 1.27f;   // Energy effect modulation rate in Hz
+bool adaptiveComplexityEnabled = true; // Lower the Opus complexity when a frame takes too long
+float cpuBudgetPercent = 50.0f; // Share of the frame period our effects plus encoding may use
+bool adaptiveShedEffects = false; // Also skip the reverb when the lowest complexity isn't enough
+bool surroundEffectsEnabled = true; // Run the effects on multistream (surround) encoders too
+int fecMode = 0;               // In-band FEC: 0 = leave it to Discord, 1 = off, 2 = on
+float packetLossPercent = 10.0f; // Expected packet loss the encoder tunes FEC for
+const char* fecModeNames[] = { "Discord Default", "FEC Off", "FEC On" };
+bool decoderEffectsEnabled = false; // Run incoming voices through the receive chain
+float decoderGainDb = 0.0f;    // Receive gain before the EQ
+float decoderBassDb = 0.0f;    // Receive EQ bands
+float decoderMidDb = 0.0f;
+float decoderTrebleDb = 0.0f;
+bool decoderCompEnabled = true; // Per-voice compressor, evens out loud and quiet users
+float decoderCompThresholdDb = -24.0f;
+float decoderCompRatio = 3.0f;
 
 // Forward declarations
 void StyleTabBar();
@@ -481,6 +540,66 @@ void CreateConfiguration(const char* file_path) {
         bool default_in_head_left = false;
         bool default_in_head_right = false;
 
+        // Default reverb storage mode
+        bool default_reverb_half_precision = false;
+
+        // Default limiter look-ahead
+        float default_limiter_lookahead = 2.0f;
+
+        // Default auto gain settings
+        bool default_agc_enabled = false;
+        float default_agc_target = -16.0f;
+        float default_agc_attack = 50.0f;
+        float default_agc_release = 800.0f;
+        float default_agc_hold = 300.0f;
+
+        // Default saturator curve
+        int default_saturator_type = (int)SaturatorType::Tanh;
+
+        // Default compressor settings
+        bool default_comp_enabled = false;
+        float default_comp_threshold = -18.0f;
+        float default_comp_ratio = 4.0f;
+        float default_comp_knee = 6.0f;
+        float default_comp_attack = 5.0f;
+        float default_comp_release = 120.0f;
+        float default_comp_makeup = 0.0f;
+        bool default_comp_linked = true;
+
+        // Default noise gate settings
+        float default_gate_open = -55.0f;
+        float default_gate_close = -61.0f;
+        float default_gate_hold = 200.0f;
+        float default_gate_attack = 2.0f;
+        float default_gate_release = 80.0f;
+        bool default_gate_dtx = true;
+
+        // Default energy modulation
+        int default_energy_lfo_shape = (int)LfoShape::Sine;
+        float default_energy_lfo_rate = 1.27f;
+
+        // Default CPU budget
+        bool default_adaptive_complexity = true;
+        float default_cpu_budget = 50.0f;
+        bool default_shed_effects = false;
+
+        // Default surround effects
+        bool default_surround_effects = true;
+
+        // Default packet loss settings
+        int default_fec_mode = 0;
+        float default_packet_loss = 10.0f;
+
+        // Default receive chain
+        bool default_decoder_effects = false;
+        float default_decoder_gain = 0.0f;
+        float default_decoder_bass = 0.0f;
+        float default_decoder_mid = 0.0f;
+        float default_decoder_treble = 0.0f;
+        bool default_decoder_comp = true;
+        float default_decoder_comp_threshold = -24.0f;
+        float default_decoder_comp_ratio = 3.0f;
+
         // Write default values to file
         ofs.write(reinterpret_cast<const char*>(&default_gain), sizeof(default_gain));
         ofs.write(reinterpret_cast<const char*>(&default_exp_gain), sizeof(default_exp_gain));
@@ -508,6 +627,44 @@ void CreateConfiguration(const char* file_path) {
         ofs.write(reinterpret_cast<const char*>(&default_panning), sizeof(default_panning));
         ofs.write(reinterpret_cast<const char*>(&default_in_head_left), sizeof(default_in_head_left));
         ofs.write(reinterpret_cast<const char*>(&default_in_head_right), sizeof(default_in_head_right));
+        ofs.write(reinterpret_cast<const char*>(&default_reverb_half_precision), sizeof(default_reverb_half_precision));
+        ofs.write(reinterpret_cast<const char*>(&default_limiter_lookahead), sizeof(default_limiter_lookahead));
+        ofs.write(reinterpret_cast<const char*>(&default_agc_enabled), sizeof(default_agc_enabled));
+        ofs.write(reinterpret_cast<const char*>(&default_agc_target), sizeof(default_agc_target));
+        ofs.write(reinterpret_cast<const char*>(&default_agc_attack), sizeof(default_agc_attack));
+        ofs.write(reinterpret_cast<const char*>(&default_agc_release), sizeof(default_agc_release));
+        ofs.write(reinterpret_cast<const char*>(&default_agc_hold), sizeof(default_agc_hold));
+        ofs.write(reinterpret_cast<const char*>(&default_saturator_type), sizeof(default_saturator_type));
+        ofs.write(reinterpret_cast<const char*>(&default_comp_enabled), sizeof(default_comp_enabled));
+        ofs.write(reinterpret_cast<const char*>(&default_comp_threshold), sizeof(default_comp_threshold));
+        ofs.write(reinterpret_cast<const char*>(&default_comp_ratio), sizeof(default_comp_ratio));
+        ofs.write(reinterpret_cast<const char*>(&default_comp_knee), sizeof(default_comp_knee));
+        ofs.write(reinterpret_cast<const char*>(&default_comp_attack), sizeof(default_comp_attack));
+        ofs.write(reinterpret_cast<const char*>(&default_comp_release), sizeof(default_comp_release));
+        ofs.write(reinterpret_cast<const char*>(&default_comp_makeup), sizeof(default_comp_makeup));
+        ofs.write(reinterpret_cast<const char*>(&default_comp_linked), sizeof(default_comp_linked));
+        ofs.write(reinterpret_cast<const char*>(&default_gate_open), sizeof(default_gate_open));
+        ofs.write(reinterpret_cast<const char*>(&default_gate_close), sizeof(default_gate_close));
+        ofs.write(reinterpret_cast<const char*>(&default_gate_hold), sizeof(default_gate_hold));
+        ofs.write(reinterpret_cast<const char*>(&default_gate_attack), sizeof(default_gate_attack));
+        ofs.write(reinterpret_cast<const char*>(&default_gate_release), sizeof(default_gate_release));
+        ofs.write(reinterpret_cast<const char*>(&default_gate_dtx), sizeof(default_gate_dtx));
+        ofs.write(reinterpret_cast<const char*>(&default_energy_lfo_shape), sizeof(default_energy_lfo_shape));
+        ofs.write(reinterpret_cast<const char*>(&default_energy_lfo_rate), sizeof(default_energy_lfo_rate));
+        ofs.write(reinterpret_cast<const char*>(&default_adaptive_complexity), sizeof(default_adaptive_complexity));
+        ofs.write(reinterpret_cast<const char*>(&default_cpu_budget), sizeof(default_cpu_budget));
+        ofs.write(reinterpret_cast<const char*>(&default_shed_effects), sizeof(default_shed_effects));
+        ofs.write(reinterpret_cast<const char*>(&default_surround_effects), sizeof(default_surround_effects));
+        ofs.write(reinterpret_cast<const char*>(&default_fec_mode), sizeof(default_fec_mode));
+        ofs.write(reinterpret_cast<const char*>(&default_packet_loss), sizeof(default_packet_loss));
+        ofs.write(reinterpret_cast<const char*>(&default_decoder_effects), sizeof(default_decoder_effects));
+        ofs.write(reinterpret_cast<const char*>(&default_decoder_gain), sizeof(default_decoder_gain));
+        ofs.write(reinterpret_cast<const char*>(&default_decoder_bass), sizeof(default_decoder_bass));
+        ofs.write(reinterpret_cast<const char*>(&default_decoder_mid), sizeof(default_decoder_mid));
+        ofs.write(reinterpret_cast<const char*>(&default_decoder_treble), sizeof(default_decoder_treble));
+        ofs.write(reinterpret_cast<const char*>(&default_decoder_comp), sizeof(default_decoder_comp));
+        ofs.write(reinterpret_cast<const char*>(&default_decoder_comp_threshold), sizeof(default_decoder_comp_threshold));
+        ofs.write(reinterpret_cast<const char*>(&default_decoder_comp_ratio), sizeof(default_decoder_comp_ratio));
         ofs.close();
     }
 }
@@ -560,6 +717,66 @@ void SaveConfiguration(const char* file_path) {
         ofs.write(reinterpret_cast<const char*>(&inHeadLeft), sizeof(inHeadLeft));
         ofs.write(reinterpret_cast<const char*>(&inHeadRight), sizeof(inHeadRight));
 
+        // Save reverb storage mode
+        ofs.write(reinterpret_cast<const char*>(&reverbHalfPrecision), sizeof(reverbHalfPrecision));
+
+        // Save limiter look-ahead
+        ofs.write(reinterpret_cast<const char*>(&limiterLookaheadMs), sizeof(limiterLookaheadMs));
+
+        // Save auto gain settings
+        ofs.write(reinterpret_cast<const char*>(&agcEnabled), sizeof(agcEnabled));
+        ofs.write(reinterpret_cast<const char*>(&agcTargetLufs), sizeof(agcTargetLufs));
+        ofs.write(reinterpret_cast<const char*>(&agcAttackMs), sizeof(agcAttackMs));
+        ofs.write(reinterpret_cast<const char*>(&agcReleaseMs), sizeof(agcReleaseMs));
+        ofs.write(reinterpret_cast<const char*>(&agcHoldMs), sizeof(agcHoldMs));
+
+        // Save saturator curve
+        ofs.write(reinterpret_cast<const char*>(&saturatorType), sizeof(saturatorType));
+
+        // Save compressor settings
+        ofs.write(reinterpret_cast<const char*>(&compEnabled), sizeof(compEnabled));
+        ofs.write(reinterpret_cast<const char*>(&compThresholdDb), sizeof(compThresholdDb));
+        ofs.write(reinterpret_cast<const char*>(&compRatio), sizeof(compRatio));
+        ofs.write(reinterpret_cast<const char*>(&compKneeDb), sizeof(compKneeDb));
+        ofs.write(reinterpret_cast<const char*>(&compAttackMs), sizeof(compAttackMs));
+        ofs.write(reinterpret_cast<const char*>(&compReleaseMs), sizeof(compReleaseMs));
+        ofs.write(reinterpret_cast<const char*>(&compMakeupDb), sizeof(compMakeupDb));
+        ofs.write(reinterpret_cast<const char*>(&compLinked), sizeof(compLinked));
+
+        // Save noise gate settings
+        ofs.write(reinterpret_cast<const char*>(&gateOpenDb), sizeof(gateOpenDb));
+        ofs.write(reinterpret_cast<const char*>(&gateCloseDb), sizeof(gateCloseDb));
+        ofs.write(reinterpret_cast<const char*>(&gateHoldMs), sizeof(gateHoldMs));
+        ofs.write(reinterpret_cast<const char*>(&gateAttackMs), sizeof(gateAttackMs));
+        ofs.write(reinterpret_cast<const char*>(&gateReleaseMs), sizeof(gateReleaseMs));
+        ofs.write(reinterpret_cast<const char*>(&gateDtxEnabled), sizeof(gateDtxEnabled));
+
+        // Save energy modulation
+        ofs.write(reinterpret_cast<const char*>(&energyLfoShape), sizeof(energyLfoShape));
+        ofs.write(reinterpret_cast<const char*>(&energyLfoRate), sizeof(energyLfoRate));
+
+        // Save CPU budget
+        ofs.write(reinterpret_cast<const char*>(&adaptiveComplexityEnabled), sizeof(adaptiveComplexityEnabled));
+        ofs.write(reinterpret_cast<const char*>(&cpuBudgetPercent), sizeof(cpuBudgetPercent));
+        ofs.write(reinterpret_cast<const char*>(&adaptiveShedEffects), sizeof(adaptiveShedEffects));
+
+        // Save surround effects
+        ofs.write(reinterpret_cast<const char*>(&surroundEffectsEnabled), sizeof(surroundEffectsEnabled));
+
+        // Save packet loss settings
+        ofs.write(reinterpret_cast<const char*>(&fecMode), sizeof(fecMode));
+        ofs.write(reinterpret_cast<const char*>(&packetLossPercent), sizeof(packetLossPercent));
+
+        // Save receive chain
+        ofs.write(reinterpret_cast<const char*>(&decoderEffectsEnabled), sizeof(decoderEffectsEnabled));
+        ofs.write(reinterpret_cast<const char*>(&decoderGainDb), sizeof(decoderGainDb));
+        ofs.write(reinterpret_cast<const char*>(&decoderBassDb), sizeof(decoderBassDb));
+        ofs.write(reinterpret_cast<const char*>(&decoderMidDb), sizeof(decoderMidDb));
+        ofs.write(reinterpret_cast<const char*>(&decoderTrebleDb), sizeof(decoderTrebleDb));
+        ofs.write(reinterpret_cast<const char*>(&decoderCompEnabled), sizeof(decoderCompEnabled));
+        ofs.write(reinterpret_cast<const char*>(&decoderCompThresholdDb), sizeof(decoderCompThresholdDb));
+        ofs.write(reinterpret_cast<const char*>(&decoderCompRatio), sizeof(decoderCompRatio));
+
         ofs.close();
     }
 }
@@ -668,6 +885,129 @@ void LoadConfiguration(const char* file_path) {
             }
         }
 
+        // Try to read reverb storage mode if it exists
+        if (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(&reverbHalfPrecision), sizeof(reverbHalfPrecision));
+        }
+
+        // Try to read limiter look-ahead if it exists
+        if (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(&limiterLookaheadMs), sizeof(limiterLookaheadMs));
+            // Ensure value is within valid range
+            limiterLookaheadMs = Max(PeakLimiter::MIN_LOOKAHEAD_MS, Min(limiterLookaheadMs, PeakLimiter::MAX_LOOKAHEAD_MS));
+        }
+
+        // Try to read auto gain settings if they exist
+        if (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(&agcEnabled), sizeof(agcEnabled));
+            if (ifs.peek() != EOF) {
+                ifs.read(reinterpret_cast<char*>(&agcTargetLufs), sizeof(agcTargetLufs));
+                ifs.read(reinterpret_cast<char*>(&agcAttackMs), sizeof(agcAttackMs));
+                ifs.read(reinterpret_cast<char*>(&agcReleaseMs), sizeof(agcReleaseMs));
+                ifs.read(reinterpret_cast<char*>(&agcHoldMs), sizeof(agcHoldMs));
+                // Ensure values are within valid range
+                agcTargetLufs = Max(-40.0f, Min(agcTargetLufs, -5.0f));
+                agcAttackMs = Max(5.0f, Min(agcAttackMs, 500.0f));
+                agcReleaseMs = Max(100.0f, Min(agcReleaseMs, 5000.0f));
+                agcHoldMs = Max(0.0f, Min(agcHoldMs, 2000.0f));
+            }
+        }
+
+        // Try to read saturator curve if it exists
+        if (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(&saturatorType), sizeof(saturatorType));
+            // Ensure value is within valid range
+            saturatorType = Max(0, Min(saturatorType, (int)SaturatorType::Count - 1));
+        }
+
+        // Try to read compressor settings if they exist
+        if (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(&compEnabled), sizeof(compEnabled));
+            if (ifs.peek() != EOF) {
+                ifs.read(reinterpret_cast<char*>(&compThresholdDb), sizeof(compThresholdDb));
+                ifs.read(reinterpret_cast<char*>(&compRatio), sizeof(compRatio));
+                ifs.read(reinterpret_cast<char*>(&compKneeDb), sizeof(compKneeDb));
+                ifs.read(reinterpret_cast<char*>(&compAttackMs), sizeof(compAttackMs));
+                ifs.read(reinterpret_cast<char*>(&compReleaseMs), sizeof(compReleaseMs));
+                ifs.read(reinterpret_cast<char*>(&compMakeupDb), sizeof(compMakeupDb));
+                ifs.read(reinterpret_cast<char*>(&compLinked), sizeof(compLinked));
+                // Ensure values are within valid range
+                compThresholdDb = Max(-60.0f, Min(compThresholdDb, 0.0f));
+                compRatio = Max(1.0f, Min(compRatio, 20.0f));
+                compKneeDb = Max(0.0f, Min(compKneeDb, 24.0f));
+                compAttackMs = Max(0.5f, Min(compAttackMs, 200.0f));
+                compReleaseMs = Max(10.0f, Min(compReleaseMs, 2000.0f));
+                compMakeupDb = Max(0.0f, Min(compMakeupDb, 24.0f));
+            }
+        }
+
+        // Try to read noise gate settings if they exist
+        if (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(&gateOpenDb), sizeof(gateOpenDb));
+            ifs.read(reinterpret_cast<char*>(&gateCloseDb), sizeof(gateCloseDb));
+            ifs.read(reinterpret_cast<char*>(&gateHoldMs), sizeof(gateHoldMs));
+            ifs.read(reinterpret_cast<char*>(&gateAttackMs), sizeof(gateAttackMs));
+            ifs.read(reinterpret_cast<char*>(&gateReleaseMs), sizeof(gateReleaseMs));
+            ifs.read(reinterpret_cast<char*>(&gateDtxEnabled), sizeof(gateDtxEnabled));
+            // Ensure values are within valid range
+            gateOpenDb = Max(-90.0f, Min(gateOpenDb, -20.0f));
+            gateCloseDb = Max(-90.0f, Min(gateCloseDb, gateOpenDb));
+            gateHoldMs = Max(0.0f, Min(gateHoldMs, 1000.0f));
+            gateAttackMs = Max(0.5f, Min(gateAttackMs, 50.0f));
+            gateReleaseMs = Max(5.0f, Min(gateReleaseMs, 500.0f));
+        }
+
+        // Try to read energy modulation if it exists
+        if (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(&energyLfoShape), sizeof(energyLfoShape));
+            ifs.read(reinterpret_cast<char*>(&energyLfoRate), sizeof(energyLfoRate));
+            // Ensure values are within valid range
+            energyLfoShape = Max(0, Min(energyLfoShape, (int)LfoShape::Count - 1));
+            energyLfoRate = Max(0.1f, Min(energyLfoRate, 10.0f));
+        }
+
+        // Try to read CPU budget if it exists
+        if (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(&adaptiveComplexityEnabled), sizeof(adaptiveComplexityEnabled));
+            ifs.read(reinterpret_cast<char*>(&cpuBudgetPercent), sizeof(cpuBudgetPercent));
+            ifs.read(reinterpret_cast<char*>(&adaptiveShedEffects), sizeof(adaptiveShedEffects));
+            // Ensure values are within valid range
+            cpuBudgetPercent = Max(10.0f, Min(cpuBudgetPercent, 90.0f));
+        }
+
+        // Try to read surround effects if it exists
+        if (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(&surroundEffectsEnabled), sizeof(surroundEffectsEnabled));
+        }
+
+        // Try to read packet loss settings if it exists
+        if (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(&fecMode), sizeof(fecMode));
+            ifs.read(reinterpret_cast<char*>(&packetLossPercent), sizeof(packetLossPercent));
+            // Ensure values are within valid range
+            fecMode = Max(0, Min(fecMode, 2));
+            packetLossPercent = Max(0.0f, Min(packetLossPercent, 50.0f));
+        }
+
+        // Try to read receive chain if it exists
+        if (ifs.peek() != EOF) {
+            ifs.read(reinterpret_cast<char*>(&decoderEffectsEnabled), sizeof(decoderEffectsEnabled));
+            ifs.read(reinterpret_cast<char*>(&decoderGainDb), sizeof(decoderGainDb));
+            ifs.read(reinterpret_cast<char*>(&decoderBassDb), sizeof(decoderBassDb));
+            ifs.read(reinterpret_cast<char*>(&decoderMidDb), sizeof(decoderMidDb));
+            ifs.read(reinterpret_cast<char*>(&decoderTrebleDb), sizeof(decoderTrebleDb));
+            ifs.read(reinterpret_cast<char*>(&decoderCompEnabled), sizeof(decoderCompEnabled));
+            ifs.read(reinterpret_cast<char*>(&decoderCompThresholdDb), sizeof(decoderCompThresholdDb));
+            ifs.read(reinterpret_cast<char*>(&decoderCompRatio), sizeof(decoderCompRatio));
+            // Ensure values are within valid range
+            decoderGainDb = Max(-24.0f, Min(decoderGainDb, 24.0f));
+            decoderBassDb = Max(-12.0f, Min(decoderBassDb, 12.0f));
+            decoderMidDb = Max(-12.0f, Min(decoderMidDb, 12.0f));
+            decoderTrebleDb = Max(-12.0f, Min(decoderTrebleDb, 12.0f));
+            decoderCompThresholdDb = Max(-60.0f, Min(decoderCompThresholdDb, 0.0f));
+            decoderCompRatio = Max(1.0f, Min(decoderCompRatio, 20.0f));
+        }
+
         ifs.close();
 
         // If we have a window, update the hotkey registration
@@ -728,6 +1068,66 @@ void ResetConfiguration() {
     inHeadLeft = false;
     inHeadRight = false;
 
+    // Reset reverb storage mode
+    reverbHalfPrecision = false;
+
+    // Reset limiter look-ahead
+    limiterLookaheadMs = 2.0f;
+
+    // Reset auto gain settings
+    agcEnabled = false;
+    agcTargetLufs = -16.0f;
+    agcAttackMs = 50.0f;
+    agcReleaseMs = 800.0f;
+    agcHoldMs = 300.0f;
+
+    // Reset saturator curve
+    saturatorType = (int)SaturatorType::Tanh;
+
+    // Reset compressor settings
+    compEnabled = false;
+    compThresholdDb = -18.0f;
+    compRatio = 4.0f;
+    compKneeDb = 6.0f;
+    compAttackMs = 5.0f;
+    compReleaseMs = 120.0f;
+    compMakeupDb = 0.0f;
+    compLinked = true;
+
+    // Reset noise gate settings
+    gateOpenDb = -55.0f;
+    gateCloseDb = -61.0f;
+    gateHoldMs = 200.0f;
+    gateAttackMs = 2.0f;
+    gateReleaseMs = 80.0f;
+    gateDtxEnabled = true;
+
+    // Reset energy modulation
+    energyLfoShape = (int)LfoShape::Sine;
+    energyLfoRate = 1.27f;
+
+    // Reset CPU budget
+    adaptiveComplexityEnabled = true;
+    cpuBudgetPercent = 50.0f;
+    adaptiveShedEffects = false;
+
+    // Reset surround effects
+    surroundEffectsEnabled = true;
+
+    // Reset packet loss settings
+    fecMode = 0;
+    packetLossPercent = 10.0f;
+
+    // Reset receive chain
+    decoderEffectsEnabled = false;
+    decoderGainDb = 0.0f;
+    decoderBassDb = 0.0f;
+    decoderMidDb = 0.0f;
+    decoderTrebleDb = 0.0f;
+    decoderCompEnabled = true;
+    decoderCompThresholdDb = -24.0f;
+    decoderCompRatio = 3.0f;
+
     // If we have a window, update the hotkey registration
     if (hwnd) {
         UnregisterHotKey(hwnd, 1);
@@ -1056,10 +1456,6 @@ struct BandPassFilter {
     }
 };
 
-// Define EQ filters
-BandPassFilter bassFilter, midFilter, highFilter;
-BandPassFilter deesingFilter; // Add de-essing filter to reduce harsh S sounds
-
 // Replace MultiTapEcho with FreeverbReverb - based on Freeverb algorithm
 class FreeverbReverb {
 private:
@@ -1083,39 +1479,66 @@ private:
     // Internal buffer sizes (adjust these if needed for performance)
     static constexpr int STEREO_SPREAD = 23;
 
+    // Parameter changes are ramped over this long to avoid zipper noise
+    static constexpr float PARAM_RAMP_SECONDS = 0.02f;
+
     // Comb filter tunings for 44.1kHz (will be adjusted for actual sample rate)
     static constexpr int COMB_TUNING_L[NUM_COMBS] = { 1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617 };
     static constexpr int ALLPASS_TUNING_L[NUM_ALLPASSES] = { 556, 441, 341, 225 };
 
-    // Comb filter implementation
+    // Delay lines are sized for the highest rate Opus runs at, so init() can retune
+    // for any encoder rate on the audio thread without allocating
+    static constexpr int MAX_SAMPLE_RATE = 48000;
+    static constexpr int MAX_COMB_SIZE = 1617 * MAX_SAMPLE_RATE / 44100 + STEREO_SPREAD + 1;
+    static constexpr int MAX_ALLPASS_SIZE = 556 * MAX_SAMPLE_RATE / 44100 + STEREO_SPREAD + 1;
+
+    // Delay line samples, stored either as float or as FP16. In half precision mode
+    // only the first half of the bytes is touched, halving the cache footprint.
+    template <int Capacity>
+    struct DelayStorage {
+        union {
+            float full[Capacity] = {};
+            unsigned short half[Capacity];
+        };
+
+        template <bool Half>
+        inline float read(int idx) const {
+            if constexpr (Half) return _cvtsh_ss(half[idx]);
+            else return full[idx];
+        }
+
+        template <bool Half>
+        inline void write(int idx, float value) {
+            if constexpr (Half) half[idx] = _cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT);
+            else full[idx] = value;
+        }
+
+        // Clears enough bytes for either format
+        void clear(int size) {
+            memset(full, 0, size * sizeof(float));
+        }
+    };
+
+    // Comb filter implementation. Feedback and damping are shared by all combs and
+    // passed in per sample, so they can be ramped without touching every filter.
     struct Comb {
-        float* buffer = nullptr;
+        DelayStorage<MAX_COMB_SIZE> buffer;
         int bufsize = 0;
         int bufidx = 0;
-        float feedback = 0.0f;
         float filterstore = 0.0f;
-        float damp1 = 0.0f;
-        float damp2 = 0.0f;
-
-        ~Comb() {
-            if (buffer) delete[] buffer;
-            buffer = nullptr;
-        }
 
         void init(int size) {
-            bufsize = size;
+            bufsize = Min(size, MAX_COMB_SIZE);
             bufidx = 0;
-            filterstore = 0.0f;
-
-            if (buffer) delete[] buffer;
-            buffer = new float[size]();  // Zero-initialize
+            mute();
         }
 
-        inline float process(float input) {
-            float output = buffer[bufidx];
+        template <bool Half>
+        inline float process(float input, float feedback, float damp1, float damp2) {
+            float output = buffer.read<Half>(bufidx);
             filterstore = (output * damp2) + (filterstore * damp1);
 
-            buffer[bufidx] = input + (filterstore * feedback);
+            buffer.write<Half>(bufidx, input + (filterstore * feedback));
             if (++bufidx >= bufsize) bufidx = 0;
 
             return output;
@@ -1123,53 +1546,34 @@ private:
 
         void mute() {
             filterstore = 0.0f;
-            if (buffer) {
-                memset(buffer, 0, bufsize * sizeof(float));
-            }
-        }
-
-        void setdamp(float val) {
-            damp1 = val;
-            damp2 = 1.0f - val;
-        }
-
-        void setfeedback(float val) {
-            feedback = val;
+            buffer.clear(bufsize);
         }
     };
 
     // Allpass filter implementation
     struct Allpass {
-        float* buffer = nullptr;
+        DelayStorage<MAX_ALLPASS_SIZE> buffer;
         int bufsize = 0;
         int bufidx = 0;
         float feedback = 0.5f;
 
-        ~Allpass() {
-            if (buffer) delete[] buffer;
-            buffer = nullptr;
-        }
-
         void init(int size) {
-            bufsize = size;
+            bufsize = Min(size, MAX_ALLPASS_SIZE);
             bufidx = 0;
-
-            if (buffer) delete[] buffer;
-            buffer = new float[size]();  // Zero-initialize
+            mute();
         }
 
+        template <bool Half>
         inline float process(float input) {
-            float output = buffer[bufidx];
-            buffer[bufidx] = input + (output * feedback);
+            float output = buffer.read<Half>(bufidx);
+            buffer.write<Half>(bufidx, input + (output * feedback));
             if (++bufidx >= bufsize) bufidx = 0;
 
             return output - input;
         }
 
         void mute() {
-            if (buffer) {
-                memset(buffer, 0, bufsize * sizeof(float));
-            }
+            buffer.clear(bufsize);
         }
 
         void setfeedback(float val) {
@@ -1177,6 +1581,15 @@ private:
         }
     };
 
+    // Values the kernel actually uses, derived from the control parameters below
+    struct KernelParams {
+        float feedback = 0.0f;
+        float damp = 0.0f;
+        float wet1 = 0.0f;
+        float wet2 = 0.0f;
+        float dry = 0.0f;
+    };
+
     // Filter arrays
     Comb combL[NUM_COMBS];
     Comb combR[NUM_COMBS];
@@ -1188,70 +1601,102 @@ private:
     float roomsize = INITIAL_ROOM * SCALE_ROOM + OFFSET_ROOM;
     float damp = INITIAL_DAMP * SCALE_DAMP;
     float wet = INITIAL_WET * SCALE_WET;
-    float wet1 = INITIAL_WIDTH / 2.0f * wet;
-    float wet2 = (1.0f - INITIAL_WIDTH) / 2.0f * wet;
     float dry = INITIAL_DRY * SCALE_DRY;
     float width = INITIAL_WIDTH;
     float mode = INITIAL_MODE;
+    bool frozen = false;
+
+    // Set by the setters, consumed by process() which starts a new ramp
+    bool paramsDirty = true;
+
+    // Last values passed to updateParams, so unchanged settings cost nothing
+    float lastSize = -1.0f;
+    float lastDampening = -1.0f;
+    float lastWidth = -1.0f;
+    float lastMix = -1.0f;
+
+    // Per-sample parameter ramp
+    KernelParams current;
+    KernelParams target;
+    KernelParams step;
+    int rampSamples = 960;
+    int rampRemaining = 0;
 
     // Sample rate and other state
     int sampleRate = 48000;
     int channels = 2;
     bool initialized = false;
+    bool halfPrecision = false;    // Delay lines stored as FP16
     float sampleRateRatio = 1.0f;  // Used to adjust buffer sizes for different sample rates
 
+    // Idle detection - the comb/allpass network is skipped once the tail has decayed
+    TailTracker tail;
+
 public:
     FreeverbReverb() = default;
 
-    ~FreeverbReverb() {
-        // Cleanup handled by destructors of Comb and Allpass
-    }
-
+    // Retune the delay lines for a sample rate (8-48 kHz). Never allocates, so it is
+    // safe to call from the audio thread whenever the encoder configuration changes.
     void init(int rate, int numChannels) {
         // Set state
-        sampleRate = rate;
+        sampleRate = Max(8000, Min(rate, MAX_SAMPLE_RATE));
         channels = numChannels;
         initialized = false;
 
         // Calculate sample rate ratio compared to 44.1kHz
         sampleRateRatio = (float)sampleRate / 44100.0f;
+        rampSamples = Max(1, (int)(sampleRate * PARAM_RAMP_SECONDS));
 
-        try {
-            // Initialize comb filters with adjusted sizes for sample rate
-            for (int i = 0; i < NUM_COMBS; i++) {
-                int adjustedSize = (int)(COMB_TUNING_L[i] * sampleRateRatio);
-                if (adjustedSize < 10) adjustedSize = 10;  // Safety
-
-                combL[i].init(adjustedSize);
-                combR[i].init(adjustedSize + STEREO_SPREAD);
-            }
-
-            // Initialize allpass filters with adjusted sizes for sample rate
-            for (int i = 0; i < NUM_ALLPASSES; i++) {
-                int adjustedSize = (int)(ALLPASS_TUNING_L[i] * sampleRateRatio);
-                if (adjustedSize < 10) adjustedSize = 10;  // Safety
+        // Initialize comb filters with adjusted sizes for sample rate
+        for (int i = 0; i < NUM_COMBS; i++) {
+            int adjustedSize = (int)(COMB_TUNING_L[i] * sampleRateRatio);
+            if (adjustedSize < 10) adjustedSize = 10;  // Safety
 
-                allpassL[i].init(adjustedSize);
-                allpassR[i].init(adjustedSize + STEREO_SPREAD);
+            combL[i].init(adjustedSize);
+            combR[i].init(adjustedSize + STEREO_SPREAD);
+        }
 
-                allpassL[i].setfeedback(0.5f);
-                allpassR[i].setfeedback(0.5f);
-            }
+        // Initialize allpass filters with adjusted sizes for sample rate
+        for (int i = 0; i < NUM_ALLPASSES; i++) {
+            int adjustedSize = (int)(ALLPASS_TUNING_L[i] * sampleRateRatio);
+            if (adjustedSize < 10) adjustedSize = 10;  // Safety
 
-            // Set default parameters
-            updateParams(0.8f, 0.2f, 1.0f, 0.5f);
-            mute();
+            allpassL[i].init(adjustedSize);
+            allpassR[i].init(adjustedSize + STEREO_SPREAD);
 
-            initialized = true;
+            allpassL[i].setfeedback(0.5f);
+            allpassR[i].setfeedback(0.5f);
         }
-        catch (...) {
-            initialized = false;
+
+        // The tail is gone once the longest comb plus the allpass chain has been quiet
+        int tailSamples = combR[NUM_COMBS - 1].bufsize;
+        for (int i = 0; i < NUM_ALLPASSES; i++) {
+            tailSamples += allpassR[i].bufsize;
         }
+        tail.configure(tailSamples);
+
+        initialized = true;
+
+        // Set default parameters, starting from them directly instead of ramping
+        lastSize = lastDampening = lastWidth = lastMix = -1.0f;
+        updateParams(0.8f, 0.2f, 1.0f, 0.5f);
+        target = computeTargets();
+        current = target;
+        rampRemaining = 0;
+        paramsDirty = false;
+        mute();
     }
 
-    // Update all reverb parameters at once
+    // Update all reverb parameters at once. Cheap when nothing changed, so it can be
+    // called every buffer.
     void updateParams(float size, float dampening, float reverbWidth, float mix) {
         if (!initialized) return;
+        if (size == lastSize && dampening == lastDampening && reverbWidth == lastWidth && mix == lastMix) return;
+
+        lastSize = size;
+        lastDampening = dampening;
+        lastWidth = reverbWidth;
+        lastMix = mix;
 
         setRoomSize(size);
         setDamp(dampening);
@@ -1264,57 +1709,42 @@ public:
     void process(float* inBuffer, int numSamples) {
         if (!initialized || !inBuffer || numSamples <= 0) return;
 
-        // If mono
-        if (channels == 1) {
-            for (int i = 0; i < numSamples; i++) {
-                float input = inBuffer[i] * gain;
-                float outL = 0.0f;
-                float outR = 0.0f;
-
-                // Process comb filters in parallel
-                for (int j = 0; j < NUM_COMBS; j++) {
-                    outL += combL[j].process(input);
-                    outR += combR[j].process(input);
-                }
-
-                // Process allpass filters in series
-                for (int j = 0; j < NUM_ALLPASSES; j++) {
-                    outL = allpassL[j].process(outL);
-                    outR = allpassR[j].process(outR);
-                }
+        // Pick up parameter changes made since the last block
+        if (paramsDirty) {
+            startRamp();
+        }
 
-                // Calculate stereo output
-                inBuffer[i] = outL * wet1 + outR * wet2 + inBuffer[i] * dry;
+        // While sleeping the delay lines are all zero, so a silent input only needs the dry path
+        float inputEnergy = TailTracker::meanSquare(inBuffer, numSamples * (channels == 1 ? 1 : 2));
+        if (tail.isSleeping()) {
+            if (tail.isSilent(inputEnergy)) {
+                processDry(inBuffer, numSamples);
+                return;
             }
+            tail.wake();
         }
-        // If stereo
-        else if (channels >= 2) {
-            for (int i = 0; i < numSamples; i++) {
-                float inputL = inBuffer[i * 2] * gain;
-                float inputR = inBuffer[i * 2 + 1] * gain;
-                float outL = 0.0f;
-                float outR = 0.0f;
 
-                // Process comb filters in parallel
-                for (int j = 0; j < NUM_COMBS; j++) {
-                    outL += combL[j].process(inputL);
-                    outR += combR[j].process(inputR);
-                }
+        // Energy of the wet signal, used to detect when the tail has died out
+        float wetEnergy = halfPrecision ? processWet<true>(inBuffer, numSamples)
+                                        : processWet<false>(inBuffer, numSamples);
 
-                // Process allpass filters in series
-                for (int j = 0; j < NUM_ALLPASSES; j++) {
-                    outL = allpassL[j].process(outL);
-                    outR = allpassR[j].process(outR);
-                }
+        // Once input and tail are both inaudible, flush the leftovers and go to sleep
+        if (tail.update(inputEnergy, wetEnergy / (2.0f * numSamples), numSamples)) {
+            mute();
+        }
+    }
 
-                // Calculate stereo output with cross-feed
-                float outL2 = outL * wet1 + outR * wet2;
-                float outR2 = outR * wet1 + outL * wet2;
+    bool isSleeping() const {
+        return tail.isSleeping();
+    }
 
-                inBuffer[i * 2] = outL2 + inputL * dry;
-                inBuffer[i * 2 + 1] = outR2 + inputR * dry;
-            }
-        }
+    // Switch delay line storage between float and FP16. The stored samples can't
+    // be converted in place, so the reverb restarts from silence.
+    void setHalfPrecision(bool enabled) {
+        if (enabled == halfPrecision) return;
+
+        halfPrecision = enabled;
+        mute();
     }
 
     // Set room size (affects feedback of comb filters)
@@ -1322,11 +1752,7 @@ public:
         if (!initialized) return;
 
         roomsize = value * SCALE_ROOM + OFFSET_ROOM;
-
-        for (int i = 0; i < NUM_COMBS; i++) {
-            combL[i].setfeedback(roomsize);
-            combR[i].setfeedback(roomsize);
-        }
+        paramsDirty = true;
     }
 
     // Set damping factor
@@ -1334,11 +1760,7 @@ public:
         if (!initialized) return;
 
         damp = value * SCALE_DAMP;
-
-        for (int i = 0; i < NUM_COMBS; i++) {
-            combL[i].setdamp(damp);
-            combR[i].setdamp(damp);
-        }
+        paramsDirty = true;
     }
 
     // Set wet level (reverb amount)
@@ -1346,7 +1768,7 @@ public:
         if (!initialized) return;
 
         wet = value * SCALE_WET;
-        updateWetValues();
+        paramsDirty = true;
     }
 
     // Set dry level (original signal)
@@ -1354,6 +1776,7 @@ public:
         if (!initialized) return;
 
         dry = value * SCALE_DRY;
+        paramsDirty = true;
     }
 
     // Set stereo width
@@ -1361,33 +1784,15 @@ public:
         if (!initialized) return;
 
         width = value;
-        updateWetValues();
+        paramsDirty = true;
     }
 
     // Set freezing mode (infinite sustain)
     void setFreeze(bool freezeMode) {
         if (!initialized) return;
 
-        if (freezeMode) {
-            roomsize = 1.0f;
-            damp = 0.0f;
-
-            for (int i = 0; i < NUM_COMBS; i++) {
-                combL[i].setfeedback(1.0f);
-                combR[i].setfeedback(1.0f);
-                combL[i].setdamp(0.0f);
-                combR[i].setdamp(0.0f);
-            }
-        }
-        else {
-            // Restore previous values
-            for (int i = 0; i < NUM_COMBS; i++) {
-                combL[i].setfeedback(roomsize);
-                combR[i].setfeedback(roomsize);
-                combL[i].setdamp(damp);
-                combR[i].setdamp(damp);
-            }
-        }
+        frozen = freezeMode;
+        paramsDirty = true;
     }
 
     // Mute/reset all internal buffers
@@ -1403,58 +1808,573 @@ public:
             allpassL[i].mute();
             allpassR[i].mute();
         }
+
+        // Buffers are empty now, nothing to process until real input arrives
+        tail.sleep();
     }
 
 private:
-    // Update wet1 and wet2 values based on width
-    void updateWetValues() {
-        wet1 = wet * (width / 2.0f + 0.5f);
-        wet2 = wet * ((1.0f - width) / 2.0f);
+    // Run the comb/allpass network over a block, returns the summed wet energy
+    template <bool Half>
+    float processWet(float* inBuffer, int numSamples) {
+        float wetEnergy = 0.0f;
+
+        // If mono
+        if (channels == 1) {
+            for (int i = 0; i < numSamples; i++) {
+                if (rampRemaining > 0) advanceRamp();
+
+                float damp1 = current.damp;
+                float damp2 = 1.0f - current.damp;
+                float input = inBuffer[i] * gain;
+                float outL = 0.0f;
+                float outR = 0.0f;
+
+                // Process comb filters in parallel
+                for (int j = 0; j < NUM_COMBS; j++) {
+                    outL += combL[j].process<Half>(input, current.feedback, damp1, damp2);
+                    outR += combR[j].process<Half>(input, current.feedback, damp1, damp2);
+                }
+
+                // Process allpass filters in series
+                for (int j = 0; j < NUM_ALLPASSES; j++) {
+                    outL = allpassL[j].process<Half>(outL);
+                    outR = allpassR[j].process<Half>(outR);
+                }
+
+                wetEnergy += outL * outL + outR * outR;
+
+                // Calculate stereo output
+                inBuffer[i] = outL * current.wet1 + outR * current.wet2 + inBuffer[i] * current.dry;
+            }
+        }
+        // If stereo
+        else if (channels >= 2) {
+            for (int i = 0; i < numSamples; i++) {
+                if (rampRemaining > 0) advanceRamp();
+
+                float damp1 = current.damp;
+                float damp2 = 1.0f - current.damp;
+                float inputL = inBuffer[i * 2] * gain;
+                float inputR = inBuffer[i * 2 + 1] * gain;
+                float outL = 0.0f;
+                float outR = 0.0f;
+
+                // Process comb filters in parallel
+                for (int j = 0; j < NUM_COMBS; j++) {
+                    outL += combL[j].process<Half>(inputL, current.feedback, damp1, damp2);
+                    outR += combR[j].process<Half>(inputR, current.feedback, damp1, damp2);
+                }
+
+                // Process allpass filters in series
+                for (int j = 0; j < NUM_ALLPASSES; j++) {
+                    outL = allpassL[j].process<Half>(outL);
+                    outR = allpassR[j].process<Half>(outR);
+                }
+
+                wetEnergy += outL * outL + outR * outR;
+
+                // Calculate stereo output with cross-feed
+                float outL2 = outL * current.wet1 + outR * current.wet2;
+                float outR2 = outR * current.wet1 + outL * current.wet2;
+
+                inBuffer[i * 2] = outL2 + inputL * current.dry;
+                inBuffer[i * 2 + 1] = outR2 + inputR * current.dry;
+            }
+        }
+
+        return wetEnergy;
+    }
+
+    // Dry-only output, identical to process() with empty delay lines
+    void processDry(float* inBuffer, int numSamples) {
+        if (channels == 1) {
+            for (int i = 0; i < numSamples; i++) {
+                if (rampRemaining > 0) advanceRamp();
+                inBuffer[i] *= current.dry;
+            }
+        }
+        else {
+            for (int i = 0; i < numSamples; i++) {
+                if (rampRemaining > 0) advanceRamp();
+                float dryGain = gain * current.dry;
+                inBuffer[i * 2] *= dryGain;
+                inBuffer[i * 2 + 1] *= dryGain;
+            }
+        }
+    }
+
+    // Kernel values for the current control parameters (wet1/wet2 follow the width)
+    KernelParams computeTargets() const {
+        KernelParams p;
+        p.feedback = frozen ? 1.0f : roomsize;
+        p.damp = frozen ? 0.0f : damp;
+        p.wet1 = wet * (width / 2.0f + 0.5f);
+        p.wet2 = wet * ((1.0f - width) / 2.0f);
+        p.dry = dry;
+        return p;
+    }
+
+    // Ramp from wherever the kernel currently is to the new targets
+    void startRamp() {
+        paramsDirty = false;
+        target = computeTargets();
+
+        float inv = 1.0f / rampSamples;
+        step.feedback = (target.feedback - current.feedback) * inv;
+        step.damp = (target.damp - current.damp) * inv;
+        step.wet1 = (target.wet1 - current.wet1) * inv;
+        step.wet2 = (target.wet2 - current.wet2) * inv;
+        step.dry = (target.dry - current.dry) * inv;
+        rampRemaining = rampSamples;
+    }
+
+    inline void advanceRamp() {
+        if (--rampRemaining == 0) {
+            // Land exactly on the targets so rounding never accumulates
+            current = target;
+            return;
+        }
+
+        current.feedback += step.feedback;
+        current.damp += step.damp;
+        current.wet1 += step.wet1;
+        current.wet2 += step.wet2;
+        current.dry += step.dry;
+    }
+};
+
+// Output true-peak meter fall rate after the peak hold
+static constexpr float TRUE_PEAK_FALL_DB_PER_SEC = 20.0f;
+
+// Meter readouts for the UI. Several encoders can be live at once, the first active
+// one owns the display until it has been idle for a second.
+static constexpr unsigned long long METER_OWNER_TIMEOUT_MS = 1000;
+struct MeterDisplay {
+    std::atomic<const void*> owner{ nullptr };
+    std::atomic<unsigned long long> ownerTick{ 0 };
+
+    std::atomic<float> truePeakDb{ -120.0f };
+    std::atomic<float> momentaryLufs{ LoudnessMeter::SILENCE_LUFS };
+    std::atomic<float> shortTermLufs{ LoudnessMeter::SILENCE_LUFS };
+    std::atomic<float> integratedLufs{ LoudnessMeter::SILENCE_LUFS };
+    std::atomic<float> agcGainDb{ 0.0f };
+    std::atomic<float> compReductionDb{ 0.0f };
+    std::atomic<bool> gateOpen{ false };
+
+    std::atomic<float> cpuLoad{ 0.0f };
+    std::atomic<float> effectsUs{ 0.0f };
+    std::atomic<float> encodeUs{ 0.0f };
+    std::atomic<int> complexity{ ComplexityController::MAX_COMPLEXITY };
+    std::atomic<bool> effectsShed{ false };
+    std::atomic<int> lastDecision{ (int)ComplexityDecision::None };
+    std::atomic<unsigned int> decisionCount{ 0 };
+};
+MeterDisplay meterDisplay;
+
+// opus_encoder_ctl calls skipped by the per-encoder caches, shown on the Infos tab
+std::atomic<unsigned long long> ctlCallsSaved{ 0 };
+
+// Offline measurements started from the Infos tab
+BenchmarkRunner benchmarkRunner;
+
+// Ogg Opus capture of what we send, toggled from the Settings tab
+PacketRecorder packetRecorder;
+
+// Bumped by the UI's loudness reset button, every stream resets when it sees a new value
+std::atomic<unsigned int> loudnessResetGeneration{ 0 };
+
+// Largest frame the encoder accepts: 120 ms at 48 kHz, stereo
+static constexpr int MAX_FRAME_SAMPLES = 5760 * 2;
+
+// Biquad coefficient set, in the same layout as BandPassFilter
+struct BiquadDesign {
+    float a0, a1, a2, b1, b2, gain;
+};
+
+// Reference EQ designs - all tuned at 48 kHz, rescaled for other encoder rates
+// Bass filter (lowpass, cutoff ~200Hz) - EXTREMELY POWERFUL
+// Stronger feed-forward taps, more resonance and 2.5x gain for massive bass impact
+static const BiquadDesign BASS_DESIGN_48K = { 0.025f, 0.050f, 0.025f, -1.70f, 0.80f, 2.5f };
+// Mid filter (bandpass, center ~1kHz) - EXTREMELY POWERFUL
+// Wider Q and stronger gain for much more dramatic mid range boost
+static const BiquadDesign MID_DESIGN_48K = { 0.15f, 0.0f, -0.15f, -1.80f, 0.85f, 2.2f };
+// High filter (highpass, extremely aggressive slope, cutoff ~4.5kHz) - EXTREMELY POWERFUL
+// Ultra aggressive slope for dramatically pronounced high frequency enhancement
+static const BiquadDesign HIGH_DESIGN_48K = { 0.50f, -0.87f, 0.50f, -0.87f, 0.45f, 2.6f };
+// De-essing filter (notch around 6-8kHz where sibilance occurs)
+// Narrow notch so non-S sounds are not muffled, gain kept high to preserve highs
+static const BiquadDesign DEESS_DESIGN_48K = { 0.87f, -1.65f, 0.87f, -1.65f, 0.85f, 0.75f };
+
+// Move the roots of 1 + p*z^-1 + q*z^-2 from 48 kHz to a rate `scale` times lower
+// (matched-z: every root z = r*e^(jw) becomes r^scale * e^(j*w*scale), capped at Nyquist)
+static void RescaleQuadratic(float& p, float& q, float scale) {
+    float halfP = -0.5f * p;
+    float disc = halfP * halfP - q;
+
+    if (disc < 0.0f) {
+        // Complex pair
+        float radius = sqrtf(q);
+        float angle = Min(atan2f(sqrtf(-disc), halfP) * scale, MY_PI);
+        float newRadius = powf(radius, scale);
+        p = -2.0f * newRadius * cosf(angle);
+        q = newRadius * newRadius;
+    }
+    else {
+        // Two real roots - positive ones stay at DC, negative ones stay at Nyquist
+        float roots[2] = { halfP + sqrtf(disc), halfP - sqrtf(disc) };
+        for (float& root : roots) {
+            root = root >= 0.0f ? powf(root, scale) : -powf(-root, scale);
+        }
+        p = -(roots[0] + roots[1]);
+        q = roots[0] * roots[1];
+    }
+}
+
+// Magnitude response of a biquad at normalized angular frequency w
+static float BiquadMagnitude(const BiquadDesign& d, float w) {
+    float c1 = cosf(w), s1 = sinf(w);
+    float c2 = cosf(2.0f * w), s2 = sinf(2.0f * w);
+    float numRe = d.a0 + d.a1 * c1 + d.a2 * c2;
+    float numIm = -(d.a1 * s1 + d.a2 * s2);
+    float denRe = 1.0f + d.b1 * c1 + d.b2 * c2;
+    float denIm = -(d.b1 * s1 + d.b2 * s2);
+    float den = denRe * denRe + denIm * denIm;
+    return den > 1e-20f ? sqrtf((numRe * numRe + numIm * numIm) / den) : 0.0f;
+}
+
+// Load a 48 kHz reference design into a filter running at sampleRate
+static void ApplyBiquadDesign(BandPassFilter& filter, const BiquadDesign& design, int sampleRate) {
+    BiquadDesign d = design;
+
+    if (sampleRate != 48000 && fabsf(design.a0) > 1e-9f) {
+        float scale = 48000.0f / sampleRate;
+
+        float zeroP = design.a1 / design.a0;
+        float zeroQ = design.a2 / design.a0;
+        RescaleQuadratic(zeroP, zeroQ, scale);
+        RescaleQuadratic(d.b1, d.b2, scale);
+        d.a0 = design.a0;
+        d.a1 = design.a0 * zeroP;
+        d.a2 = design.a0 * zeroQ;
+
+        // Match the level where the reference response peaks, within the new band
+        float maxFreq = Min(16000.0f, 0.45f * sampleRate);
+        float peakFreq = 30.0f;
+        float peakMagnitude = 0.0f;
+        for (int i = 0; i < 48; i++) {
+            float freq = 30.0f * powf(maxFreq / 30.0f, i / 47.0f);
+            float magnitude = BiquadMagnitude(design, 2.0f * MY_PI * freq / 48000.0f);
+            if (magnitude > peakMagnitude) {
+                peakMagnitude = magnitude;
+                peakFreq = freq;
+            }
+        }
+
+        float newMagnitude = BiquadMagnitude(d, 2.0f * MY_PI * peakFreq / sampleRate);
+        if (newMagnitude > 1e-9f) {
+            float correction = peakMagnitude / newMagnitude;
+            d.a0 *= correction;
+            d.a1 *= correction;
+            d.a2 *= correction;
+        }
     }
+
+    filter.a0 = d.a0;
+    filter.a1 = d.a1;
+    filter.a2 = d.a2;
+    filter.b1 = d.b1;
+    filter.b2 = d.b2;
+    filter.gain = d.gain;
+    filter.reset();
+}
+
+// Per-sample one-pole coefficient tuned at 48 kHz, converted so the time constant
+// stays the same at sampleRate
+static float RescaleSmoothingCoefficient(float coefficient48k, int sampleRate) {
+    return 1.0f - powf(1.0f - coefficient48k, 48000.0f / sampleRate);
+}
+
+// Format the DSP chain is currently configured for. Owned by the audio thread.
+struct AudioChainConfig {
+    int sampleRate = 0;
+    int channels = 0;
+
+    // Envelope follower coefficients of the de-esser
+    float sEnvelopeAttack = 0.0008f;
+    float sEnvelopeRelease = 0.05f;
+};
+
+// Everything one encoder stream owns: its DSP chain, the history that used to live in
+// function statics and its working buffers. Discord can run more than one encoder at a
+// time (voice plus Go Live audio, or two during a reconnect), each one gets its own
+// context so they never share filter or envelope state.
+struct EncoderContext {
+    AudioChainConfig chain;
+
+    // Encoder settings we applied, so unchanged ones aren't sent again
+    EncoderCtlCache ctl;
+
+    // Keeps effects plus encoding inside the CPU budget
+    ComplexityController complexity;
+
+    // Encoder lookahead in 48 kHz samples for the recorder's header, -1 until queried
+    int recordPreSkip = -1;
+
+    // Discord's DTX setting while the gate overrides it, -1 when it doesn't
+    int hostDtx = -1;
+
+    // EQ and de-essing filters
+    BandPassFilter bassFilter, midFilter, highFilter;
+    BandPassFilter deesingFilter;
+
+    NoiseGate gate;
+    Saturator eqSaturator;
+    FreeverbReverb reverb;
+    Lfo energyLfo;
+    Saturator energySaturator;
+    Compressor compressor;
+    AutoGainControl autoGain;
+    TruePeakDetector limiterSidechain;
+    PeakLimiter limiter;
+    TruePeakDetector truePeak;
+    LoudnessMeter loudness;
+
+    // Idle detection of the dynamics stages, like the reverb's. The limiter's covers its
+    // true-peak sidechain and the output meters too.
+    TailTracker compressorTail;
+    TailTracker autoGainTail;
+    TailTracker limiterTail;
+
+    // Parameter smoothing and effect toggles of the previous buffer
+    float prevBassEQ = 0.0f;
+    float prevMidEQ = 0.0f;
+    float prevHighEQ = 0.0f;
+    float prevGain = 1.0f;
+    float prevExpGain = 1.0f;
+    float prevVunitsGain = 1.0f;
+    bool prevBassBoostEnabled = false;
+    bool prevReverbEnabled = false;
+    bool prevCompEnabled = false;
+    bool prevAgcEnabled = false;
+
+    // Sibilance detectors of the gain stage
+    float prevAbsSample = 0.0f;
+    float prevDelta = 0.0f;
+    float sEnvelope = 0.0f;
+    float prevSEnvelope = 0.0f;
+
+    // Panning and in-head history
+    float prevLeftSample = 0.0f;
+    float prevRightSample = 0.0f;
+    float leftDelayBuffer[8] = {};
+    float rightDelayBuffer[8] = {};
+    int delayBufferIndex = 0;
+
+    // Output meters
+    float heldTruePeak = 0.0f;
+    unsigned int loudnessResetSeen = 0;
+
+    // Fill for frames the gate has closed when DTX is off
+    ComfortNoise comfortNoise;
+
+    // Working buffers, part of the context so a frame never allocates
+    float floatFrame[MAX_FRAME_SAMPLES];
+    opus_int16 pcmFrame[MAX_FRAME_SAMPLES];
+    float processedBuffer[MAX_FRAME_SAMPLES];
+    float truePeakLevels[MAX_FRAME_SAMPLES];
+    float energyModulation[MAX_FRAME_SAMPLES];
 };
 
-// Global reverb processor
-FreeverbReverb reverbProcessor;
-
-// Initialize EQ filters with appropriate coefficients
-void InitEQFilters() {
-    // Bass filter (lowpass, cutoff ~200Hz at 48kHz sample rate) - EXTREMELY POWERFUL
-    bassFilter.a0 = 0.025f;  // Increased for stronger bass response
-    bassFilter.a1 = 0.050f;  // Increased for stronger bass response
-    bassFilter.a2 = 0.025f;  // Increased for stronger bass response
-    bassFilter.b1 = -1.70f;  // Adjusted for more resonance
-    bassFilter.b2 = 0.80f;   // Increased for stronger bass effect
-    bassFilter.gain = 2.5f;  // Dramatically increased from 1.2f for massive bass impact
-
-    // Mid filter (bandpass, center ~1kHz at 48kHz sample rate) - EXTREMELY POWERFUL
-    // Wider Q and stronger gain for much more dramatic mid range boost
-    midFilter.a0 = 0.15f;    // Increased from 0.10f for stronger mid response
-    midFilter.a1 = 0.0f;
-    midFilter.a2 = -0.15f;   // Increased for stronger mid response
-    midFilter.b1 = -1.80f;   // Adjusted for more presence
-    midFilter.b2 = 0.85f;    // Increased for more resonance
-    midFilter.gain = 2.2f;   // Dramatically increased from 1.0f for massive mid range impact
-
-    // High filter (highpass, extremely aggressive slope, cutoff ~4.5kHz) - EXTREMELY POWERFUL
-    // Ultra aggressive slope for dramatically pronounced high frequency enhancement
-    highFilter.a0 = 0.50f;   // Increased from 0.45f for stronger high frequency presence 
-    highFilter.a1 = -0.87f;  // Adjusted from -0.90f for more upper harmonic content
-    highFilter.a2 = 0.50f;   // Increased from 0.45f for stronger high frequency presence
-    highFilter.b1 = -0.87f;  // Adjusted from -0.90f for more upper harmonic content
-    highFilter.b2 = 0.45f;   // Decreased from 0.50f for less filtering of high frequencies
-    highFilter.gain = 2.6f;  // Increased from 2.4f for stronger high frequency presence
-
-    // De-essing filter (notch around 6-8kHz where sibilance occurs)
-    // More aggressive de-essing filter parameters for stronger S reduction
-    deesingFilter.a0 = 0.87f;  // Reduced from 0.94f to make less aggressive on non-S sounds
-    deesingFilter.a1 = -1.65f; // Adjusted from -1.82f for narrower notch to prevent muffling
-    deesingFilter.a2 = 0.87f;  // Reduced from 0.94f to make less aggressive on non-S sounds
-    deesingFilter.b1 = -1.65f; // Adjusted from -1.82f for narrower notch to prevent muffling
-    deesingFilter.b2 = 0.85f;  // Increased from 0.78f for less aggressive filtering
-    deesingFilter.gain = 0.75f; // Increased from 0.60f to preserve high frequencies
-
-    // Initialize reverb processor with default settings
-    reverbProcessor.init(48000, 2); // 48kHz stereo
+// Contexts of the live encoders, keyed by OpusEncoder*. Encoders that disappear without
+// going through the destroy hook are evicted once they've been idle this long. All 16
+// contexts are built with the map when the DLL loads; a new encoder resets a free one
+// in place, so the encode thread never allocates or frees one.
+static constexpr unsigned long long ENCODER_CONTEXT_IDLE_MS = 30000;
+LockFreePointerMap<EncoderContext, 16> encoderContexts;
+
+// Context for an encoder, taken from the pool on its first frame. nullptr when all are in use.
+EncoderContext* AcquireEncoderContext(const OpusEncoder* st) {
+    unsigned long long now = GetTickCount64();
+    if (EncoderContext* ctx = encoderContexts.find(st, now)) {
+        return ctx;
+    }
+
+    // New stream: clean up after encoders that went away before making room for it
+    encoderContexts.evictStale(now, ENCODER_CONTEXT_IDLE_MS);
+    return encoderContexts.findOrInsert(st, now);
+}
+
+// Original opus_encoder_destroy, only set when the destroy hook is installed
+void (*original_opus_encoder_destroy)(OpusEncoder* st) = nullptr;
+
+// Hand the stream's context back to the pool together with its encoder, and the
+// recording over to whichever encoder replaces it
+extern "C" void custom_opus_encoder_destroy(OpusEncoder* st) {
+    encoderContexts.erase(st);
+    packetRecorder.release(st);
+
+    if (original_opus_encoder_destroy) {
+        original_opus_encoder_destroy(st);
+    }
+}
+
+// High resolution wall clock in microseconds, for the per-frame CPU budget
+double NowMicroseconds() {
+    static const double microsecondsPerTick = [] {
+        LARGE_INTEGER frequency;
+        QueryPerformanceFrequency(&frequency);
+        return 1000000.0 / (double)frequency.QuadPart;
+    }();
+
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * microsecondsPerTick;
+}
+
+// Hand this stream's meter values to the UI if it owns the display
+void PublishMeters(const EncoderContext& ctx, const void* key) {
+    unsigned long long now = GetTickCount64();
+    const void* owner = meterDisplay.owner.load(std::memory_order_relaxed);
+    if (owner != key) {
+        if (owner && now - meterDisplay.ownerTick.load(std::memory_order_relaxed) < METER_OWNER_TIMEOUT_MS) {
+            return;
+        }
+        meterDisplay.owner.store(key, std::memory_order_relaxed);
+    }
+    meterDisplay.ownerTick.store(now, std::memory_order_relaxed);
+
+    meterDisplay.truePeakDb.store(20.0f * log10f(Max(ctx.heldTruePeak, 1e-6f)), std::memory_order_relaxed);
+    meterDisplay.momentaryLufs.store(ctx.loudness.getMomentary(), std::memory_order_relaxed);
+    meterDisplay.shortTermLufs.store(ctx.loudness.getShortTerm(), std::memory_order_relaxed);
+    meterDisplay.integratedLufs.store(ctx.loudness.getIntegrated(), std::memory_order_relaxed);
+    meterDisplay.agcGainDb.store(ctx.autoGain.getGainDb(), std::memory_order_relaxed);
+    meterDisplay.compReductionDb.store(ctx.compressor.getGainReductionDb(), std::memory_order_relaxed);
+    meterDisplay.gateOpen.store(ctx.gate.isOpen(), std::memory_order_relaxed);
+
+    meterDisplay.cpuLoad.store(ctx.complexity.getLoad(), std::memory_order_relaxed);
+    meterDisplay.effectsUs.store(ctx.complexity.getEffectsUs(), std::memory_order_relaxed);
+    meterDisplay.encodeUs.store(ctx.complexity.getEncodeUs(), std::memory_order_relaxed);
+    meterDisplay.complexity.store(ctx.complexity.getPublishedComplexity(), std::memory_order_relaxed);
+    meterDisplay.effectsShed.store(ctx.complexity.getPublishedShedding(), std::memory_order_relaxed);
+    meterDisplay.lastDecision.store((int)ctx.complexity.getLastDecision(), std::memory_order_relaxed);
+    meterDisplay.decisionCount.store(ctx.complexity.getDecisionCount(), std::memory_order_relaxed);
+}
+
+// Everything the effect chain reads from the UI. The encode hook copies it once per
+// frame, so a slider moving mid-frame can't change settings halfway through the chain,
+// and offline runs (the effect matrix benchmark) can bring settings of their own.
+struct EffectSettings {
+    float bassEQ, midEQ, highEQ;
+    float Gain, ExpGain, VunitsGain;
+    bool bassBoostEnabled;
+    int saturatorType;
+    bool reverbEnabled, reverbHalfPrecision;
+    float reverbMix, reverbSize, reverbDamping, reverbWidth;
+    bool energyEnabled;
+    float energyValue;
+    int energyLfoShape;
+    float energyLfoRate;
+    bool compEnabled, compLinked;
+    float compThresholdDb, compRatio, compKneeDb, compAttackMs, compReleaseMs, compMakeupDb;
+    bool agcEnabled;
+    float agcTargetLufs, agcAttackMs, agcReleaseMs, agcHoldMs;
+    int audioChannelMode;
+    float panningValue;
+    bool inHeadLeft, inHeadRight;
+    float limiterLookaheadMs;
+};
+
+// Snapshot of the current UI settings
+static EffectSettings CaptureEffectSettings() {
+    EffectSettings fx;
+    fx.bassEQ = bassEQ;
+    fx.midEQ = midEQ;
+    fx.highEQ = highEQ;
+    fx.Gain = Gain;
+    fx.ExpGain = ExpGain;
+    fx.VunitsGain = VunitsGain;
+    fx.bassBoostEnabled = bassBoostEnabled;
+    fx.saturatorType = saturatorType;
+    fx.reverbEnabled = reverbEnabled;
+    fx.reverbHalfPrecision = reverbHalfPrecision;
+    fx.reverbMix = reverbMix;
+    fx.reverbSize = reverbSize;
+    fx.reverbDamping = reverbDamping;
+    fx.reverbWidth = reverbWidth;
+    fx.energyEnabled = energyEnabled;
+    fx.energyValue = energyValue;
+    fx.energyLfoShape = energyLfoShape;
+    fx.energyLfoRate = energyLfoRate;
+    fx.compEnabled = compEnabled;
+    fx.compLinked = compLinked;
+    fx.compThresholdDb = compThresholdDb;
+    fx.compRatio = compRatio;
+    fx.compKneeDb = compKneeDb;
+    fx.compAttackMs = compAttackMs;
+    fx.compReleaseMs = compReleaseMs;
+    fx.compMakeupDb = compMakeupDb;
+    fx.agcEnabled = agcEnabled;
+    fx.agcTargetLufs = agcTargetLufs;
+    fx.agcAttackMs = agcAttackMs;
+    fx.agcReleaseMs = agcReleaseMs;
+    fx.agcHoldMs = agcHoldMs;
+    fx.audioChannelMode = audioChannelMode;
+    fx.panningValue = panningValue;
+    fx.inHeadLeft = inHeadLeft;
+    fx.inHeadRight = inHeadRight;
+    fx.limiterLookaheadMs = limiterLookaheadMs;
+    return fx;
+}
+
+// Retune the whole chain (EQ, de-esser, reverb, envelope followers) for one encoder.
+// Called from the encode hook, only does work when the format actually changed.
+void ConfigureAudioChain(EncoderContext& ctx, int sampleRate, int channels) {
+    // Opus only runs at 8, 12, 16, 24 and 48 kHz
+    sampleRate = Max(8000, Min(sampleRate, 48000));
+    channels = Max(1, Min(channels, 2));
+
+    if (sampleRate == ctx.chain.sampleRate && channels == ctx.chain.channels) {
+        return;
+    }
+
+    ctx.chain.sampleRate = sampleRate;
+    ctx.chain.channels = channels;
+
+    ApplyBiquadDesign(ctx.bassFilter, BASS_DESIGN_48K, sampleRate);
+    ApplyBiquadDesign(ctx.midFilter, MID_DESIGN_48K, sampleRate);
+    ApplyBiquadDesign(ctx.highFilter, HIGH_DESIGN_48K, sampleRate);
+    ApplyBiquadDesign(ctx.deesingFilter, DEESS_DESIGN_48K, sampleRate);
+
+    ctx.chain.sEnvelopeAttack = RescaleSmoothingCoefficient(0.0008f, sampleRate);
+    ctx.chain.sEnvelopeRelease = RescaleSmoothingCoefficient(0.05f, sampleRate);
+
+    // Reverb delay lines are preallocated for 48 kHz, retuning them is allocation free
+    ctx.reverb.init(sampleRate, channels);
+
+    // Dynamics stages sleep after their longest release (plus hold) of silence
+    ctx.compressorTail.configure(sampleRate * 2);                   // 2 s release
+    ctx.autoGainTail.configure(sampleRate * 7);                     // 5 s release, 2 s hold
+    ctx.limiterTail.configure(sampleRate * (int)(PeakLimiter::MAX_LOOKAHEAD_MS + PeakLimiter::DEFAULT_RELEASE_MS) / 1000);
+}
+
+// Format the loudness readout, values under the -70 LUFS gate show as "-inf"
+const char* FormatLoudnessText(float momentary, float shortTerm, float integrated) {
+    static char buffer[64];
+    char parts[3][12];
+    const float values[3] = { momentary, shortTerm, integrated };
+
+    for (int i = 0; i < 3; i++) {
+        if (values[i] < -70.0f) {
+            snprintf(parts[i], sizeof(parts[i]), "-inf");
+        }
+        else {
+            snprintf(parts[i], sizeof(parts[i]), "%.1f", values[i]);
+        }
+    }
+
+    snprintf(buffer, sizeof(buffer), "M %s  S %s  I %s LUFS", parts[0], parts[1], parts[2]);
+    return buffer;
 }
 
 // Format panning value to string safely to prevent crashes
@@ -1485,61 +2405,59 @@ const char* FormatPanningText(float value) {
 }
 
 // Safe audio processing that handles stereo properly
-void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
+// Whether a stateful stage has to run on a block with this input energy. A sleeping
+// stage stays asleep while the input is silent, its output would be silent too.
+static bool StageAwake(TailTracker& tail, float inputEnergy) {
+    if (!tail.isSleeping()) return true;
+    if (tail.isSilent(inputEnergy)) return false;
+    tail.wake();
+    return true;
+}
+
+void ApplyAudioEffects(EncoderContext& ctx, const EffectSettings& fx, float* audioBuffer, int bufferSize, int channels) {
     // Input validation to prevent crashes
     if (!audioBuffer || bufferSize <= 0 || channels <= 0) {
         return;
     }
 
-    // Static variables for smoothing parameter changes
-    static float prevBassEQ = 0.0f;
-    static float prevMidEQ = 0.0f;
-    static float prevHighEQ = 0.0f;
-    static float prevGain = 1.0f;
-    static float prevExpGain = 1.0f;
-    static float prevVunitsGain = 1.0f;
-    static bool prevBassBoostEnabled = false;
-
     // Smoothing factor - higher values = faster transitions
     const float smoothingFactor = 0.2f;
 
     // Smoothly interpolate parameters to prevent audio artifacts
-    float smoothBassEQ = prevBassEQ + smoothingFactor * (bassEQ - prevBassEQ);
-    float smoothMidEQ = prevMidEQ + smoothingFactor * (midEQ - prevMidEQ);
-    float smoothHighEQ = prevHighEQ + smoothingFactor * (highEQ - prevHighEQ);
-    float smoothGain = prevGain + smoothingFactor * (Gain - prevGain);
-    float smoothExpGain = prevExpGain + smoothingFactor * (ExpGain - prevExpGain);
-    float smoothVunitsGain = prevVunitsGain + smoothingFactor * (VunitsGain - prevVunitsGain);
+    float smoothBassEQ = ctx.prevBassEQ + smoothingFactor * (fx.bassEQ - ctx.prevBassEQ);
+    float smoothMidEQ = ctx.prevMidEQ + smoothingFactor * (fx.midEQ - ctx.prevMidEQ);
+    float smoothHighEQ = ctx.prevHighEQ + smoothingFactor * (fx.highEQ - ctx.prevHighEQ);
+    float smoothGain = ctx.prevGain + smoothingFactor * (fx.Gain - ctx.prevGain);
+    float smoothExpGain = ctx.prevExpGain + smoothingFactor * (fx.ExpGain - ctx.prevExpGain);
+    float smoothVunitsGain = ctx.prevVunitsGain + smoothingFactor * (fx.VunitsGain - ctx.prevVunitsGain);
 
     // Store for next buffer
-    prevBassEQ = smoothBassEQ;
-    prevMidEQ = smoothMidEQ;
-    prevHighEQ = smoothHighEQ;
-    prevGain = smoothGain;
-    prevExpGain = smoothExpGain;
-    prevVunitsGain = smoothVunitsGain;
+    ctx.prevBassEQ = smoothBassEQ;
+    ctx.prevMidEQ = smoothMidEQ;
+    ctx.prevHighEQ = smoothHighEQ;
+    ctx.prevGain = smoothGain;
+    ctx.prevExpGain = smoothExpGain;
+    ctx.prevVunitsGain = smoothVunitsGain;
 
     // Reset filters for this buffer
-    bassFilter.reset();
-    midFilter.reset();
-    highFilter.reset();
-    deesingFilter.reset();
+    ctx.bassFilter.reset();
+    ctx.midFilter.reset();
+    ctx.highFilter.reset();
+    ctx.deesingFilter.reset();
 
-    // Create temporary buffer for processing
-    float* processedBuffer = nullptr;
-    try {
-        processedBuffer = new float[bufferSize * channels];
-        if (!processedBuffer) {
-            return; // Memory allocation failed
-        }
+    // Preallocated working buffer - nothing on the audio thread allocates
+    if (bufferSize * channels > MAX_FRAME_SAMPLES) {
+        return;
+    }
 
+    try {
         // First copy the original buffer
-        memcpy(processedBuffer, audioBuffer, bufferSize * channels * sizeof(float));
+        memcpy(ctx.processedBuffer, audioBuffer, bufferSize * channels * sizeof(float));
 
         // Pre-processing safety check: scan for extreme values and scale down if needed
         float maxAmplitude = 0.0f;
         for (int i = 0; i < bufferSize * channels; i++) {
-            float absValue = fabsf(processedBuffer[i]);
+            float absValue = fabsf(ctx.processedBuffer[i]);
             if (absValue > maxAmplitude) {
                 maxAmplitude = absValue;
             }
@@ -1550,7 +2468,7 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
         if (maxAmplitude > 0.9f) {
             safetyScale = 0.9f / maxAmplitude;
             for (int i = 0; i < bufferSize * channels; i++) {
-                processedBuffer[i] *= safetyScale;
+                ctx.processedBuffer[i] *= safetyScale;
             }
         }
 
@@ -1561,18 +2479,18 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
             float bassBoostTransition = 0.0f;
 
             // If bass boost state changed, gradually apply it across the buffer
-            if (bassBoostEnabled != prevBassBoostEnabled) {
-                bassBoostTransition = bassBoostEnabled ? interpolationFactor : (1.0f - interpolationFactor);
+            if (fx.bassBoostEnabled != ctx.prevBassBoostEnabled) {
+                bassBoostTransition = fx.bassBoostEnabled ? interpolationFactor : (1.0f - interpolationFactor);
             }
             else {
-                bassBoostTransition = bassBoostEnabled ? 1.0f : 0.0f;
+                bassBoostTransition = fx.bassBoostEnabled ? 1.0f : 0.0f;
             }
 
             for (int ch = 0; ch < channels; ch++) {
                 int idx = i * channels + ch;
 
                 // Make a copy of the original sample
-                float original = processedBuffer[idx];
+                float original = ctx.processedBuffer[idx];
 
                 // Scale down bass EQ effect based on the input level to prevent overloading
                 // Higher input levels get less aggressive bass to prevent clipping
@@ -1590,14 +2508,14 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
                 // More aggressive scaling for the dramatically increased max value (70 instead of 30)
                 // Use custom curve to make the effect more dramatic at higher values
                 float bassEQScaled = (smoothBassEQ / 25.0f) * (1.0f + (smoothBassEQ / 70.0f));
-                float bassOut = bassFilter.process(bassInputSafe) * bassEQScaled * dynamicBassScale;
+                float bassOut = ctx.bassFilter.process(bassInputSafe) * bassEQScaled * dynamicBassScale;
 
                 // Apply bass boost if enabled (ULTRA POWERFUL bass effect separate from EQ)
-                if (bassBoostEnabled) {
+                if (fx.bassBoostEnabled) {
                     // Apply a much more aggressive bass boost with smooth transition
                     float deepBassInput = Max(-0.95f, Min(0.95f, original)); // Moderate input limiting
                     // Double-process for extreme resonance and apply stronger gain
-                    float extremeBass = bassFilter.process(bassFilter.process(deepBassInput)) * 1.5f; // Increased from 1.0f
+                    float extremeBass = ctx.bassFilter.process(ctx.bassFilter.process(deepBassInput)) * 1.5f; // Increased from 1.0f
 
                     // Less attenuation for more consistent rumble
                     float boostAttenuationFactor = 1.0f - Min(0.8f, absInput * 0.6f);
@@ -1617,17 +2535,17 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
                 float midInputSafe = Max(-0.97f, Min(0.97f, original)); // Slightly less limiting for more punch
                 // Custom mid curve for more dramatic effect at higher values
                 float midEQScaled = (smoothMidEQ / 25.0f) * (1.0f + (smoothMidEQ / 80.0f));
-                float midOut = midFilter.process(midInputSafe) * midEQScaled;
+                float midOut = ctx.midFilter.process(midInputSafe) * midEQScaled;
 
                 // Hard limit mid to prevent overflow but allow more extreme values
                 midOut = Max(-1.8f, Min(1.8f, midOut)); // Increased from -1.0/1.0 to -1.8/1.8
 
                 // Apply de-essing before high frequencies to reduce sibilance
                 float highInputSafe = Max(-0.97f, Min(0.97f, original)); // Slightly less limiting
-                float highPassed = highFilter.process(highInputSafe);
+                float highPassed = ctx.highFilter.process(highInputSafe);
 
                 // Enhanced de-essing with dynamic response
-                float deEssed = deesingFilter.process(highPassed); // De-ess the high frequencies
+                float deEssed = ctx.deesingFilter.process(highPassed); // De-ess the high frequencies
 
                 // Apply a dramatically more powerful high frequency processing
                 // Use an EXTREMELY pronounced non-linear scaling for massive effect at higher EQ values
@@ -1636,71 +2554,77 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
                 float highOut = deEssed * highEQScaled; // Much more aggressive scaling for higher max value
 
                 // Apply intelligent limiter for high frequencies to prevent harshness but allow sparkle
-                if (highOut > 1.2f) {
-                    // More gradual soft-knee limiting to maintain some brightness while preventing harshness
-                    highOut = 1.2f + (highOut - 1.2f) * 0.2f; // Less aggressive limiting for highs
-                }
-                else if (highOut < -1.2f) {
-                    // More gradual soft-knee limiting to maintain some brightness while preventing harshness
-                    highOut = -1.2f + (highOut + 1.2f) * 0.2f; // Less aggressive limiting for highs
-                }
+                // Gradual knee above +-1.2 keeps some brightness, written with min/max so it stays branchless
+                float highClamped = Max(-1.2f, Min(1.2f, highOut));
+                highOut = highClamped + (highOut - highClamped) * 0.2f; // Less aggressive limiting for highs
 
                 // Apply a more aggressive mixing approach for maximum impact while still preserving some clarity
                 float eq_mix = 0.85f; // 85% processed, 15% original signal for more power while maintaining clarity
 
                 // Combine with safety against extreme values but allow more intensity
-                float combined = original * (1.0f - eq_mix) + (original + bassOut + midOut + highOut) * eq_mix;
-
-                // Hard limit the combined EQ output to prevent clipping but allow more extreme values
-                combined = Max(-2.5f, Min(2.5f, combined)); // Increased from -2.0/2.0 to -2.5/2.5
-
-                // More sophisticated limiting with tanh for smoother ceiling when EQ is at extreme values
-                // Use a multi-stage approach to maintain more dynamics
-                if (fabsf(combined) > 1.5f) {
-                    // Very extreme values get more aggressive limiting
-                    combined = 1.5f * tanh(combined / 1.5f);
-                }
-                else if (fabsf(combined) > 1.0f) {
-                    // Moderate-high values get gentler limiting
-                    float limitFactor = 0.2f + 0.8f * ((1.5f - fabsf(combined)) / 0.5f);
-                    combined = combined * limitFactor + (combined > 0 ? 1.0f : -1.0f) * (1.0f - limitFactor);
-                }
-
-                processedBuffer[idx] = combined;
+                // The ceiling is applied to the whole frame by the saturator below
+                ctx.processedBuffer[idx] = original * (1.0f - eq_mix) + (original + bassOut + midOut + highOut) * eq_mix;
             }
         }
 
+        // Soft ceiling for the combined EQ output, one vectorized pass over the frame
+        ctx.eqSaturator.configure((SaturatorType)fx.saturatorType, channels);
+        ctx.eqSaturator.process(ctx.processedBuffer, bufferSize * channels, 1.5f);
+
         // Update bass boost state for next buffer
-        prevBassBoostEnabled = bassBoostEnabled;
+        ctx.prevBassBoostEnabled = fx.bassBoostEnabled;
+
+        // FP16 delay lines only when the CPU can convert them in hardware
+        ctx.reverb.setHalfPrecision(fx.reverbHalfPrecision && CpuFeatures::hasF16C());
+
+        // The reverb is the first stage to go when the CPU budget runs out
+        bool reverbActive = fx.reverbEnabled && !ctx.complexity.isShedding();
+
+        // Start from empty delay lines whenever the reverb gets switched on
+        if (reverbActive != ctx.prevReverbEnabled) {
+            ctx.reverb.mute();
+            ctx.prevReverbEnabled = reverbActive;
+        }
 
         // Apply reverb (if enabled)
-        if (reverbEnabled && reverbMix > 0.0f) {
+        if (reverbActive && fx.reverbMix > 0.0f) {
             // Update reverb parameters (only when processing audio to avoid clicks)
-            reverbProcessor.updateParams(reverbSize, reverbDamping, reverbWidth, reverbMix);
+            ctx.reverb.updateParams(fx.reverbSize, fx.reverbDamping, fx.reverbWidth, fx.reverbMix);
 
             // Process the audio through the reverb
-            reverbProcessor.process(processedBuffer, bufferSize);
+            ctx.reverb.process(ctx.processedBuffer, bufferSize);
         }
 
         // We'll apply panning and in-head effects after gain processing
 
         // Apply energy effect with safety limiter
-        if (energyEnabled) {
-            float energyMod = sinf(time_since_start * 8.0f) * 0.3f + 0.8f;
-            // Capped energy factor to prevent extreme values
-            float energyFactor = 1.0f + Min(3.0f, (energyValue / 750000.0f)) * energyMod;
+        if (fx.energyEnabled) {
+            // Per-frame modulation from the LFO, 0.5 to 1.1 around the energy depth
+            ctx.energyLfo.configure(ctx.chain.sampleRate);
+            ctx.energyLfo.setShape((LfoShape)fx.energyLfoShape);
+            ctx.energyLfo.setRate(fx.energyLfoRate);
+            ctx.energyLfo.render(ctx.energyModulation, bufferSize);
 
-            for (int i = 0; i < bufferSize * channels; i++) {
-                processedBuffer[i] *= energyFactor;
+            // Capped energy depth to prevent extreme values
+            float energyDepth = Min(3.0f, (fx.energyValue / 750000.0f));
 
-                // Safety limiter for energy effect
-                if (processedBuffer[i] > 1.5f) {
-                    processedBuffer[i] = 1.5f + (processedBuffer[i] - 1.5f) * 0.1f;
-                }
-                else if (processedBuffer[i] < -1.5f) {
-                    processedBuffer[i] = -1.5f + (processedBuffer[i] + 1.5f) * 0.1f;
+            for (int i = 0; i < bufferSize; i++) {
+                float energyFactor = 1.0f + energyDepth * (ctx.energyModulation[i] * 0.3f + 0.8f);
+                for (int ch = 0; ch < channels; ch++) {
+                    ctx.processedBuffer[i * channels + ch] *= energyFactor;
                 }
             }
+
+            // Safety limiter for energy effect
+            ctx.energySaturator.configure((SaturatorType)fx.saturatorType, channels);
+            ctx.energySaturator.process(ctx.processedBuffer, bufferSize * channels, 1.5f);
+        }
+
+        // Auto gain replaces the three gain sliders with loudness targeting
+        if (fx.agcEnabled) {
+            smoothGain = 1.0f;
+            smoothExpGain = 1.0f;
+            smoothVunitsGain = 1.0f;
         }
 
         // Apply gain with per-sample smoothing to prevent clicks/pops
@@ -1734,34 +2658,6 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
         // Safety cap on total gain to prevent crashes
         totalGain = Min(totalGain * vUnitsMultiplier, 250000.0f); // Reduced from 500000.0f for less distortion
 
-        // Calculate strongest limiting for extreme gain values
-        float limiterThreshold, limiterRatio, finalSafetyScale;
-        if (totalGain > 10000.0f) {
-            limiterThreshold = 0.25f; // Reduced from 0.4f to prevent distortion at high gain
-            limiterRatio = 0.005f;    // Reduced from 0.01f for smoother limiting
-            finalSafetyScale = 0.4f;  // Reduced from 0.5f for extra headroom
-        }
-        else if (totalGain > 1000.0f) {
-            limiterThreshold = 0.35f; // Reduced from 0.6f
-            limiterRatio = 0.015f;    // Reduced from 0.03f
-            finalSafetyScale = 0.55f; // Reduced from 0.7f
-        }
-        else if (totalGain > 100.0f) {
-            limiterThreshold = 0.45f; // Reduced from 0.7f
-            limiterRatio = 0.03f;     // Reduced from 0.05f
-            finalSafetyScale = 0.7f;  // Reduced from 0.8f
-        }
-        else if (totalGain > 50.0f) {
-            limiterThreshold = 0.6f;  // Reduced from 0.8f
-            limiterRatio = 0.05f;     // Reduced from 0.1f
-            finalSafetyScale = 0.8f;  // Reduced from 0.9f
-        }
-        else {
-            limiterThreshold = 0.8f;  // Reduced from 0.9f
-            limiterRatio = 0.1f;      // Reduced from 0.15f
-            finalSafetyScale = 1.0f;
-        }
-
         for (int i = 0; i < bufferSize; i++) {
             // Create smoother gain transition throughout the buffer
             // This helps especially when gain is first applied
@@ -1778,42 +2674,7 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
 
             for (int ch = 0; ch < channels; ch++) {
                 int idx = i * channels + ch;
-                // Apply a progressive soft-knee limiter BEFORE applying extreme gain
-                // This prevents harsh clipping and distortion
-                float sample = processedBuffer[idx];
-
-                // Apply a sequence of progressively stricter limiters for proper gain control
-                // First gentle compression to tame initial peaks
-                if (sample > 0.4f) { // Reduced from 0.5f for more aggressive limiting
-                    float excess = sample - 0.4f;
-                    sample = 0.4f + excess * 0.7f; // Reduced from 0.8f for stronger compression
-                }
-                else if (sample < -0.4f) { // Reduced from -0.5f
-                    float excess = -0.4f - sample;
-                    sample = -0.4f - excess * 0.7f; // Reduced from 0.8f
-                }
-
-                // Apply a second compression stage for stronger limiting
-                if (sample > 0.7f) { // Reduced from 0.8f
-                    float excess = sample - 0.7f;
-                    sample = 0.7f + excess * 0.4f; // Reduced from 0.5f for stronger compression
-                }
-                else if (sample < -0.7f) { // Reduced from -0.8f
-                    float excess = -0.7f - sample;
-                    sample = -0.7f - excess * 0.4f; // Reduced from 0.5f
-                }
-
-                // Additional third-stage limiting for extreme high gain scenarios
-                if (totalGain > 200.0f) {
-                    if (sample > 0.85f) {
-                        float excess = sample - 0.85f;
-                        sample = 0.85f + excess * 0.2f; // Very aggressive limiting for highest peaks
-                    }
-                    else if (sample < -0.85f) {
-                        float excess = -0.85f - sample;
-                        sample = -0.85f - excess * 0.2f;
-                    }
-                }
+                float sample = ctx.processedBuffer[idx];
 
                 // For high gain values, apply additional de-essing before the gain
                 // This specifically targets the sibilance (S sounds) that causes distortion at high gain
@@ -1837,12 +2698,10 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
                         // Create a multi-band approach specifically targeting "s" sounds (5-9kHz range)
                         // Use a simple but effective approach - detect rapid transients typical of sibilance
                         float currentAbsSample = fabsf(sample);
-                        static float prevAbsSample = 0.0f;
-                        static float prevDelta = 0.0f;
 
                         // Calculate rate of change - rapid positive change is characteristic of "s" sounds
-                        float delta = currentAbsSample - prevAbsSample;
-                        bool isTransient = (delta > 0.02f && delta > prevDelta * 1.2f);
+                        float delta = currentAbsSample - ctx.prevAbsSample;
+                        bool isTransient = (delta > 0.02f && delta > ctx.prevDelta * 1.2f);
 
                         // If we detect a pattern that looks like an "s" sound and we're using high combined gain, apply more reduction
                         if (isTransient) {
@@ -1854,29 +2713,17 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
                             else {
                                 sample += sReduction;
                             }
-
-                            // Apply a gentle brick-wall limit specifically for these transients
-                            float transientLimit = 0.85f - (0.2f * combinedGainFactor);
-                            if (sample > transientLimit) {
-                                sample = transientLimit + (sample - transientLimit) * 0.2f;
-                            }
-                            else if (sample < -transientLimit) {
-                                sample = -transientLimit + (sample + transientLimit) * 0.2f;
-                            }
                         }
 
                         // Store values for next sample
-                        prevAbsSample = currentAbsSample;
-                        prevDelta = delta;
+                        ctx.prevAbsSample = currentAbsSample;
+                        ctx.prevDelta = delta;
                     }
                 }
 
-                // Apply gain after limiting
+                // Apply gain - peaks are caught by the output limiter at the end of the chain
                 sample *= frameGain;
 
-                // Apply additional safety scaling for extreme gain values
-                sample *= finalSafetyScale;
-
                 // Special clarity enhancement for rage gain (when ExpGain is high)
                 if (smoothExpGain > 5.0f) {
                     // Add specific S sound handling for rage gain
@@ -1885,30 +2732,28 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
 
                     // Detect S sound characteristics - sharp transients with high frequency content
                     // Use simple but effective envelope detection
-                    static float sEnvelope = 0.0f;
                     float currentAbs = fabsf(sample);
-                    float attackTime = 0.0008f; // Faster attack to catch only true S transients
-                    float releaseTime = 0.05f;  // Faster release to avoid affecting adjacent sounds
+                    float attackTime = ctx.chain.sEnvelopeAttack;   // Faster attack to catch only true S transients
+                    float releaseTime = ctx.chain.sEnvelopeRelease; // Faster release to avoid affecting adjacent sounds
 
                     // Simple envelope follower specifically tuned for S sounds
-                    if (currentAbs > sEnvelope) {
-                        sEnvelope = sEnvelope + attackTime * (currentAbs - sEnvelope);
+                    if (currentAbs > ctx.sEnvelope) {
+                        ctx.sEnvelope = ctx.sEnvelope + attackTime * (currentAbs - ctx.sEnvelope);
                     }
                     else {
-                        sEnvelope = sEnvelope + releaseTime * (currentAbs - sEnvelope);
+                        ctx.sEnvelope = ctx.sEnvelope + releaseTime * (currentAbs - ctx.sEnvelope);
                     }
 
                     // Detect potential S sound by looking for rapid rise in envelope
                     // Make more selective to avoid affecting non-S sounds
-                    static float prevSEnvelope = 0.0f;
-                    float sRise = sEnvelope - prevSEnvelope;
-                    bool isPotentialS = (sRise > 0.05f) && (sEnvelope > 0.3f); // More selective threshold
+                    float sRise = ctx.sEnvelope - ctx.prevSEnvelope;
+                    bool isPotentialS = (sRise > 0.05f) && (ctx.sEnvelope > 0.3f); // More selective threshold
 
                     // Apply specialized S sound reduction when rage gain is active
                     if (isPotentialS) {
                         // Calculate reduction amount based on rage gain level
                         // Less aggressive to prevent muffling
-                        float sReduction = 0.2f * rageGainFactor * sEnvelope;
+                        float sReduction = 0.2f * rageGainFactor * ctx.sEnvelope;
 
                         // Apply reduction with proper sign handling
                         if (sample > 0) {
@@ -1917,26 +2762,17 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
                         else {
                             sample += sReduction;
                         }
-
-                        // Apply gentler soft clipping focused on S frequencies
-                        float softLimit = 0.85f - (0.2f * rageGainFactor); // Less aggressive limiting
-                        if (sample > softLimit) {
-                            sample = softLimit + (sample - softLimit) * 0.25f; // More gentle curve
-                        }
-                        else if (sample < -softLimit) {
-                            sample = -softLimit + (sample + softLimit) * 0.25f; // More gentle curve
-                        }
                     }
 
                     // Store envelope for next sample
-                    prevSEnvelope = sEnvelope;
+                    ctx.prevSEnvelope = ctx.sEnvelope;
 
                     // Calculate clarity factor - increased with higher rage gain
                     float clarityFactor = Min(0.5f, (smoothExpGain - 5.0f) / 120.0f); // Increased from 0.3f for more clarity
 
                     // Presence boost - enhance mid frequencies for better speech intelligibility
                     // Boost upper mids more to prevent muffled sound
-                    float presenceBoost = midFilter.process(sample) * 0.35f * clarityFactor; // Increased from 0.2f
+                    float presenceBoost = ctx.midFilter.process(sample) * 0.35f * clarityFactor; // Increased from 0.2f
 
                     // Apply subtle harmonic enhancement for clarity
                     // Add more harmonic content to compensate for de-essing
@@ -1950,26 +2786,14 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
                     sample *= (0.9f + attackSharpness * 0.1f); // Changed from 0.85f and 0.15f
                 }
 
-                // Apply an ultra-aggressive limiter after gain to prevent distortion while preserving clarity
-                if (sample > limiterThreshold) {
-                    float excess = sample - limiterThreshold;
-                    // Hard limiting with extremely low ratio for extreme gain values
-                    sample = limiterThreshold + excess * limiterRatio;
-                }
-                else if (sample < -limiterThreshold) {
-                    float excess = -limiterThreshold - sample;
-                    // Hard limiting with extremely low ratio for extreme gain values
-                    sample = -limiterThreshold - excess * limiterRatio;
-                }
-
                 // Special case for rage gain to handle S sound distortion
                 if (smoothExpGain > 20.0f) {
                     // Apply extra limiting specifically for high frequencies (S sounds)
                     // using a multi-band approach that focuses on sibilant range
-                    float sibilantThreshold = limiterThreshold - (0.15f * Min(1.0f, (smoothExpGain - 20.0f) / 100.0f));
+                    float sibilantThreshold = 0.8f - (0.15f * Min(1.0f, (smoothExpGain - 20.0f) / 100.0f));
 
                     // Process through de-essing filter to detect S energy
-                    float sBandEnergy = deesingFilter.process(sample * 0.4f);
+                    float sBandEnergy = ctx.deesingFilter.process(sample * 0.4f);
                     float absEnergy = fabsf(sBandEnergy);
 
                     // If significant energy in S band, apply targeted limiting
@@ -1993,28 +2817,52 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
                     }
                 }
 
-                // Final safety clamp with soft tanh limiting for smoother ceiling
-                // Make it more aggressive to prevent any possible distortion
-                if (totalGain > 50.0f) {
-                    // Apply a gentler tanh-based soft clipper for very high gain values
-                    sample = 0.95f * tanh(sample * 0.9f); // Added to create softer limiting
-                }
-                else if (fabs(sample) > 0.95f) {
-                    // Otherwise just apply normal soft clipping for samples near max
-                    sample = 0.95f * (sample > 0 ? 1.0f : -1.0f) +
-                        0.05f * sample; // Soft clip with linear component for more natural sound
-                }
+                // Store the processed sample with gain applied
+                ctx.processedBuffer[idx] = sample;
+            }
+        }
 
-                // Absolute safety limit to prevent any crashes
-                sample = sample > 10.0f ? 10.0f : (sample < -10.0f ? -10.0f : sample);
+        // Compressor, starting from no reduction every time it gets switched on
+        if (fx.compEnabled) {
+            ctx.compressor.configure(ctx.chain.sampleRate, channels);
+            ctx.compressor.setParams(fx.compThresholdDb, fx.compRatio, fx.compKneeDb, fx.compAttackMs, fx.compReleaseMs, fx.compMakeupDb, fx.compLinked);
+            if (!ctx.prevCompEnabled) {
+                ctx.compressor.reset();
+                ctx.compressorTail.wake();
+            }
 
-                // Store the processed sample with gain applied
-                processedBuffer[idx] = sample;
+            float inputEnergy = TailTracker::meanSquare(ctx.processedBuffer, bufferSize * channels);
+            if (StageAwake(ctx.compressorTail, inputEnergy)) {
+                ctx.compressor.process(ctx.processedBuffer, bufferSize);
+
+                // Fully released by now, the next word starts from no reduction
+                if (ctx.compressorTail.update(inputEnergy, TailTracker::meanSquare(ctx.processedBuffer, bufferSize * channels), bufferSize)) {
+                    ctx.compressor.reset();
+                }
+            }
+        }
+        ctx.prevCompEnabled = fx.compEnabled;
+
+        // Loudness-targeting auto gain, starting from unity every time it gets switched on
+        if (fx.agcEnabled) {
+            ctx.autoGain.configure(ctx.chain.sampleRate, channels);
+            ctx.autoGain.setParams(fx.agcTargetLufs, fx.agcAttackMs, fx.agcReleaseMs, fx.agcHoldMs);
+            if (!ctx.prevAgcEnabled) {
+                ctx.autoGain.reset();
+                ctx.autoGainTail.wake();
+            }
+
+            // Not reset when it goes to sleep, the gain it settled on carries over the silence
+            float inputEnergy = TailTracker::meanSquare(ctx.processedBuffer, bufferSize * channels);
+            if (StageAwake(ctx.autoGainTail, inputEnergy)) {
+                ctx.autoGain.process(ctx.processedBuffer, bufferSize);
+                ctx.autoGainTail.update(inputEnergy, TailTracker::meanSquare(ctx.processedBuffer, bufferSize * channels), bufferSize);
             }
         }
+        ctx.prevAgcEnabled = fx.agcEnabled;
 
         // Apply panning (for stereo only) AFTER gain processing for greater effect
-        if (channels == 2 && audioChannelMode == 1) { // Only apply panning in stereo mode
+        if (channels == 2 && fx.audioChannelMode == 1) { // Only apply panning in stereo mode
             // Enhanced panning with stronger effect at high gain
             float panBoostFactor = 1.0f;
             if (totalGain > 50.0f) {
@@ -2024,7 +2872,7 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
 
             // Use a more accurate panning law for better spatial positioning
             // Convert from -10.0 to 10.0 range to -1.0 to 1.0 range
-            float normalizedPanning = panningValue / 10.0f;
+            float normalizedPanning = fx.panningValue / 10.0f;
 
             // Constant power panning law (square root) for more accurate stereo imaging
             float panAngle = (normalizedPanning + 1.0f) * (MY_PI / 4.0f); // Map -1..1 to 0..PI/2
@@ -2035,18 +2883,14 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
             // Calculate micro-delay for enhanced spatial cues (subtle HRTF simulation)
             float microDelay = fabsf(normalizedPanning) * 0.2f; // 0-0.2ms max
 
-            // Previous sample buffer for inter-channel delay simulation
-            static float prevLeftSample = 0.0f;
-            static float prevRightSample = 0.0f;
-
             for (int i = 0; i < bufferSize; i++) {
                 // Safe array access 
                 int leftIdx = i * 2;
                 int rightIdx = i * 2 + 1;
 
                 if (leftIdx < bufferSize * channels && rightIdx < bufferSize * channels) {
-                    float leftSample = processedBuffer[leftIdx];
-                    float rightSample = processedBuffer[rightIdx];
+                    float leftSample = ctx.processedBuffer[leftIdx];
+                    float rightSample = ctx.processedBuffer[rightIdx];
 
                     // Apply constant power panning
                     float leftPanned = leftSample * leftGain;
@@ -2060,26 +2904,26 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
                     // Apply subtle inter-channel delay for enhanced spatial positioning
                     if (normalizedPanning < 0) { // Panning left
                         // Delay right channel slightly
-                        rightPanned = rightPanned * (1.0f - microDelay) + prevRightSample * microDelay;
+                        rightPanned = rightPanned * (1.0f - microDelay) + ctx.prevRightSample * microDelay;
                     }
                     else if (normalizedPanning > 0) { // Panning right
                         // Delay left channel slightly
-                        leftPanned = leftPanned * (1.0f - microDelay) + prevLeftSample * microDelay;
+                        leftPanned = leftPanned * (1.0f - microDelay) + ctx.prevLeftSample * microDelay;
                     }
 
                     // Store current samples for next iteration's delay
-                    prevLeftSample = leftSample;
-                    prevRightSample = rightSample;
+                    ctx.prevLeftSample = leftSample;
+                    ctx.prevRightSample = rightSample;
 
                     // Apply the more accurate panning
-                    processedBuffer[leftIdx] = leftPanned;
-                    processedBuffer[rightIdx] = rightPanned;
+                    ctx.processedBuffer[leftIdx] = leftPanned;
+                    ctx.processedBuffer[rightIdx] = rightPanned;
                 }
             }
         }
 
         // Apply In-Head effects (for stereo only) AFTER gain processing for greater effect
-        if (channels == 2 && audioChannelMode == 1) { // Only apply in-head effects in stereo mode
+        if (channels == 2 && fx.audioChannelMode == 1) { // Only apply in-head effects in stereo mode
             // Enhanced in-head effect with stronger effect at high gain
             float inHeadBoostFactor = 1.5f;
             float inHeadReductionFactor = 0.6f;
@@ -2092,10 +2936,7 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
 
             // Create more accurate in-head spatial modeling
             // Use previous sample memory for phase manipulation
-            static float leftDelayBuffer[8] = { 0 };
-            static float rightDelayBuffer[8] = { 0 };
             const int delayBufferSize = 8;
-            static int delayBufferIndex = 0;
 
             for (int i = 0; i < bufferSize; i++) {
                 int leftIdx = i * 2;
@@ -2103,18 +2944,18 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
 
                 if (leftIdx < bufferSize * channels && rightIdx < bufferSize * channels) {
                     // Get current samples
-                    float leftSample = processedBuffer[leftIdx];
-                    float rightSample = processedBuffer[rightIdx];
+                    float leftSample = ctx.processedBuffer[leftIdx];
+                    float rightSample = ctx.processedBuffer[rightIdx];
 
                     // Store samples in delay buffer
-                    leftDelayBuffer[delayBufferIndex] = leftSample;
-                    rightDelayBuffer[delayBufferIndex] = rightSample;
+                    ctx.leftDelayBuffer[ctx.delayBufferIndex] = leftSample;
+                    ctx.rightDelayBuffer[ctx.delayBufferIndex] = rightSample;
 
                     // Calculate next buffer index (circular buffer)
-                    int nextBufferIndex = (delayBufferIndex + 1) % delayBufferSize;
+                    int nextBufferIndex = (ctx.delayBufferIndex + 1) % delayBufferSize;
 
                     // In-Head Left: More accurate localization effect
-                    if (inHeadLeft) {
+                    if (fx.inHeadLeft) {
                         // Apply primary boost with natural harmonics
                         float leftEarEffect = leftSample * inHeadBoostFactor;
 
@@ -2126,21 +2967,21 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
                         float rightEarEffect = rightSample * inHeadReductionFactor;
 
                         // Add slight delayed crossfeed for more natural spatial positioning
-                        float delayedLeft = leftDelayBuffer[(delayBufferIndex + delayBufferSize - 3) % delayBufferSize];
+                        float delayedLeft = ctx.leftDelayBuffer[(ctx.delayBufferIndex + delayBufferSize - 3) % delayBufferSize];
                         rightEarEffect += delayedLeft * 0.05f;
 
                         // Apply proximity effect (bass boost on primary side)
                         // This simulates close-mic effect that happens in real earphones
-                        float bassBoost = leftDelayBuffer[(delayBufferIndex + delayBufferSize - 2) % delayBufferSize] * 0.2f;
+                        float bassBoost = ctx.leftDelayBuffer[(ctx.delayBufferIndex + delayBufferSize - 2) % delayBufferSize] * 0.2f;
                         leftEarEffect += bassBoost;
 
                         // Set the processed samples
-                        processedBuffer[leftIdx] = leftEarEffect;
-                        processedBuffer[rightIdx] = rightEarEffect;
+                        ctx.processedBuffer[leftIdx] = leftEarEffect;
+                        ctx.processedBuffer[rightIdx] = rightEarEffect;
                     }
 
                     // In-Head Right: More accurate localization effect
-                    else if (inHeadRight) {
+                    else if (fx.inHeadRight) {
                         // Apply primary boost with natural harmonics
                         float rightEarEffect = rightSample * inHeadBoostFactor;
 
@@ -2152,272 +2993,729 @@ void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels) {
                         float leftEarEffect = leftSample * inHeadReductionFactor;
 
                         // Add slight delayed crossfeed for more natural spatial positioning
-                        float delayedRight = rightDelayBuffer[(delayBufferIndex + delayBufferSize - 3) % delayBufferSize];
+                        float delayedRight = ctx.rightDelayBuffer[(ctx.delayBufferIndex + delayBufferSize - 3) % delayBufferSize];
                         leftEarEffect += delayedRight * 0.05f;
 
                         // Apply proximity effect (bass boost on primary side)
                         // This simulates close-mic effect that happens in real earphones
-                        float bassBoost = rightDelayBuffer[(delayBufferIndex + delayBufferSize - 2) % delayBufferSize] * 0.2f;
+                        float bassBoost = ctx.rightDelayBuffer[(ctx.delayBufferIndex + delayBufferSize - 2) % delayBufferSize] * 0.2f;
                         rightEarEffect += bassBoost;
 
                         // Set the processed samples
-                        processedBuffer[leftIdx] = leftEarEffect;
-                        processedBuffer[rightIdx] = rightEarEffect;
+                        ctx.processedBuffer[leftIdx] = leftEarEffect;
+                        ctx.processedBuffer[rightIdx] = rightEarEffect;
                     }
 
                     // Update delay buffer index
-                    delayBufferIndex = nextBufferIndex;
+                    ctx.delayBufferIndex = nextBufferIndex;
                 }
             }
         }
 
+        // Limiter and meters sleep together once the output has been silent for the
+        // look-ahead plus release; while asleep a silent block goes out as it is
+        ctx.limiterSidechain.configure(channels);
+        ctx.limiter.configure(ctx.chain.sampleRate, channels, fx.limiterLookaheadMs);
+        ctx.limiter.setSidechainLatency(TruePeakDetector::LATENCY);
+        ctx.truePeak.configure(channels);
+        ctx.loudness.configure(ctx.chain.sampleRate, channels);
+
+        float limiterInputEnergy = TailTracker::meanSquare(ctx.processedBuffer, bufferSize * channels);
+        float blockTruePeak = 0.0f;
+        if (StageAwake(ctx.limiterTail, limiterInputEnergy)) {
+            // True-peak sidechain, so peaks between samples (after decoding on the other end) are limited too
+            ctx.limiterSidechain.process(ctx.processedBuffer, bufferSize, ctx.truePeakLevels);
+
+            // Brickwall look-ahead limiter - always the last stage, so nothing after it
+            // can push the signal past the ceiling
+            ctx.limiter.process(ctx.processedBuffer, bufferSize, ctx.truePeakLevels);
+
+            // Meter what actually goes to the encoder
+            blockTruePeak = ctx.truePeak.process(ctx.processedBuffer, bufferSize);
+
+            // Loudness of what we send
+            ctx.loudness.process(ctx.processedBuffer, bufferSize);
+
+            // Only silence left in the delay line, start clean on the next word
+            if (ctx.limiterTail.update(limiterInputEnergy, TailTracker::meanSquare(ctx.processedBuffer, bufferSize * channels), bufferSize)) {
+                ctx.limiterSidechain.reset();
+                ctx.limiter.reset();
+            }
+        }
+        else {
+            ctx.loudness.addSilence(bufferSize);
+        }
+
+        // Hold peaks and let them fall slowly
+        float truePeakFall = powf(10.0f, -TRUE_PEAK_FALL_DB_PER_SEC * bufferSize / ctx.chain.sampleRate / 20.0f);
+        ctx.heldTruePeak = Max(blockTruePeak, ctx.heldTruePeak * truePeakFall);
+
         // Copy back to original buffer
-        memcpy(audioBuffer, processedBuffer, bufferSize * channels * sizeof(float));
+        memcpy(audioBuffer, ctx.processedBuffer, bufferSize * channels * sizeof(float));
     }
     catch (...) {
         // Handle any exceptions that might occur during processing
     }
+}
 
-    // Clean up
-    if (processedBuffer) {
-        delete[] processedBuffer;
+// Encode the frame exactly as the host passed it, through the entry point it called
+static opus_int32 EncodeUnprocessed(OpusEncoder* st, const opus_int16* pcm, const float* pcmFloat, int frame_size,
+    unsigned char* data, opus_int32 max_data_bytes) {
+    if (pcmFloat) {
+        return opus_encode_float(st, pcmFloat, frame_size, data, max_data_bytes);
     }
+    return opus_encode(st, pcm, frame_size, data, max_data_bytes);
 }
 
-// Hook function for audio callbacks - this is what would be connected to the voice processing
-extern "C" opus_int32 custom_opus_encode(OpusEncoder* st, const opus_int16* pcm, int frame_size,
+// Shared body of both encode hooks. Exactly one of pcm (int16) and pcmFloat is set. The
+// processed audio always goes to opus_encode_float, so it stays float end to end.
+static opus_int32 EncodeWithEffects(OpusEncoder* st, const opus_int16* pcm, const float* pcmFloat, int frame_size,
     unsigned char* data, opus_int32 max_data_bytes) {
     // Input validation
-    if (!st || !pcm || !data || frame_size <= 0 || max_data_bytes <= 0) {
+    if (!st || (!pcm && !pcmFloat) || !data || frame_size <= 0 || max_data_bytes <= 0) {
         // If inputs are invalid, fall back to original opus_encode
-        return opus_encode(st, pcm, frame_size, data, max_data_bytes);
+        return EncodeUnprocessed(st, pcm, pcmFloat, frame_size, data, max_data_bytes);
+    }
+
+    // This stream's state, if we can't get one the frame goes out unprocessed
+    EncoderContext* ctx = AcquireEncoderContext(st);
+    if (!ctx) {
+        return EncodeUnprocessed(st, pcm, pcmFloat, frame_size, data, max_data_bytes);
+    }
+    ctx->ctl.beginFrame(st);
+
+    // Format of this encoder, read every frame (default to 48 kHz stereo if the query fails)
+    int channels = ctx->ctl.getChannels(st, 2);
+    opus_int32 sampleRate_i32 = ctx->ctl.getSampleRate(st, 48000);
+
+    // Frames larger than our preallocated buffers can't be processed, pass them through
+    if (frame_size * channels > MAX_FRAME_SAMPLES) {
+        return EncodeUnprocessed(st, pcm, pcmFloat, frame_size, data, max_data_bytes);
     }
 
-    // Get number of channels from the encoder - use constants directly instead of the missing macro
-    int channels = 2; // Default to stereo
+    try {
+        // Retune the DSP chain if the encoder format changed (no-op otherwise)
+        ConfigureAudioChain(*ctx, (int)sampleRate_i32, channels);
+
+        // Loudness reset requested from the UI since this stream last looked
+        unsigned int resetGeneration = loudnessResetGeneration.load(std::memory_order_relaxed);
+        if (resetGeneration != ctx->loudnessResetSeen) {
+            ctx->loudnessResetSeen = resetGeneration;
+            ctx->loudness.requestReset();
+        }
+
+        // Set the bitrate (only sent when it changed)
+        // Make sure bitrateValue is within valid range
+        int bitrate = static_cast<int>(bitrateValue);
+        bitrate = Max(16000, Min(bitrate, 510000)); // Ensure value is within valid range
+        ctx->ctl.setBitrate(st, bitrate);
+
+        // Set the channel mode (mono/stereo)
+        // Convert from UI index (0 or 1) to actual channel count (1 or 2)
+        int actualChannels = audioChannelMode + 1;
+        ctx->ctl.setForceChannels(st, actualChannels);
+
+        // In-band FEC and the loss rate it's sized for, unless Discord keeps control of them
+        if (fecMode != 0) {
+            ctx->ctl.setInbandFec(st, fecMode == 2 ? 1 : 0);
+            ctx->ctl.setPacketLossPercent(st, (int)(packetLossPercent + 0.5f));
+        }
+
+        // Complexity from the CPU budget controller. It never goes above what the encoder
+        // was set to before we saw it, and goes back to that when switched off.
+        if (adaptiveComplexityEnabled || !ctx->complexity.needsCeiling()) {
+            if (ctx->complexity.needsCeiling()) {
+                ctx->complexity.setCeiling(ctx->ctl.getComplexity(st, ComplexityController::MAX_COMPLEXITY));
+            }
+            if (!adaptiveComplexityEnabled) {
+                ctx->complexity.reset();
+            }
+            ctx->complexity.setParams(cpuBudgetPercent / 100.0f, adaptiveShedEffects);
+            ctx->ctl.setComplexity(st, ctx->complexity.getComplexity());
+        }
+
+        // Working copy in float for processing (the input buffer belongs to the caller)
+        int total_samples = frame_size * channels;
+        float* floatFrame = ctx->floatFrame;
+        if (pcmFloat) {
+            memcpy(floatFrame, pcmFloat, total_samples * sizeof(float));
+        }
+        else {
+            ConvertInt16ToFloat(pcm, floatFrame, total_samples);
+        }
+
+        // Use RMS (Root Mean Square) to better detect silence
+        double rms = 0.0;
+        for (int i = 0; i < total_samples; i++) {
+            double sample = floatFrame[i] * 32768.0;
+            rms += sample * sample;
+        }
+        rms = sqrt(rms / total_samples);
+
+        // Background noise model for the comfort noise, fed with every frame
+        ctx->comfortNoise.configure((int)sampleRate_i32);
+        ctx->comfortNoise.analyze(floatFrame, frame_size, channels);
+
+        // The noise gate decides what counts as silence (open/close hysteresis plus hold)
+        float levelDb = rms > 0.0 ? (float)(20.0 * log10(rms / 32768.0)) : -120.0f;
+        ctx->gate.configure((int)sampleRate_i32);
+        ctx->gate.setParams(gateOpenDb, gateCloseDb, gateHoldMs, gateAttackMs, gateReleaseMs);
+        ctx->gate.update(levelDb, frame_size);
+
+        // Closed-gate frames go out as DTX. Discord's own setting is read when the gate
+        // takes over and put back when it lets go, otherwise DTX is left alone.
+        bool gateDtx = gateDtxEnabled && ctx->gate.isSilent();
+        if (gateDtx && ctx->hostDtx < 0) {
+            ctx->hostDtx = ctx->ctl.queryDtx(st, 0);
+        }
+        if (gateDtx) {
+            ctx->ctl.setDtx(st, 1);
+        }
+        else if (ctx->hostDtx >= 0) {
+            ctx->ctl.setDtx(st, ctx->hostDtx);
+            ctx->hostDtx = -1;
+        }
+        ctlCallsSaved.fetch_add(ctx->ctl.takeSavedCalls(), std::memory_order_relaxed);
+
+        opus_int16* pcmFrame = ctx->pcmFrame;
+
+        // Gate fully closed: skip the effect chain
+        if (ctx->gate.isSilent()) {
+            opus_int32 result;
+
+            if (gateDtxEnabled) {
+                // Digital silence lets the encoder drop to DTX packets
+                memset(pcmFrame, 0, total_samples * sizeof(opus_int16));
+                result = opus_encode(st, pcmFrame, frame_size, data, max_data_bytes);
+            }
+            else {
+                // Comfort noise shaped like the background measured between words, low
+                // enough to stay unnoticed but never digital silence, which keeps the
+                // encoder happy
+                ctx->comfortNoise.generate(floatFrame, frame_size, channels);
+                result = opus_encode_float(st, floatFrame, frame_size, data, max_data_bytes);
+            }
+
+            // If primary approach fails, try fallback strategies
+            if (result < 0) {
+                // Strategy 2: Try with DTX enabled, then put back whatever was set
+                int previousDtx = ctx->ctl.queryDtx(st, 0);
+                ctx->ctl.setDtx(st, 1);
+                result = EncodeUnprocessed(st, pcm, pcmFloat, frame_size, data, max_data_bytes);
+                ctx->ctl.setDtx(st, previousDtx);
+
+                if (result < 0) {
+                    // Strategy 3: Try with constant DC values
+                    opus_int16* dc_pcm = pcmFrame;
+                    for (int i = 0; i < total_samples; i++) {
+                        dc_pcm[i] = 64; // Very small constant value
+                    }
+
+                    result = opus_encode(st, dc_pcm, frame_size, data, max_data_bytes);
+                }
+            }
+
+            // Silent frames skip the effect chain, keep the loudness windows moving
+            ctx->loudness.addSilence(frame_size);
+            PublishMeters(*ctx, st);
+            return result;
+        }
+        else {
+            // Normal audio processing
+
+            // Gate attack/release ramps (no-op while fully open)
+            double effectsStart = NowMicroseconds();
+            ctx->gate.apply(floatFrame, frame_size, channels);
+
+            // Apply our custom effects
+            ApplyAudioEffects(*ctx, CaptureEffectSettings(), floatFrame, frame_size, channels);
+
+            // Encode the processed float frame directly, no int16 round trip
+            double encodeStart = NowMicroseconds();
+            opus_int32 result = opus_encode_float(st, floatFrame, frame_size, data, max_data_bytes);
+            double encodeEnd = NowMicroseconds();
+
+            // Frame cost against the frame period, drives the complexity for the next frames
+            if (adaptiveComplexityEnabled) {
+                ctx->complexity.update(encodeStart - effectsStart, encodeEnd - encodeStart, frame_size * 1000000.0 / sampleRate_i32);
+            }
+            PublishMeters(*ctx, st);
+            return result;
+        }
+    }
+    catch (...) {
+        // If any exception occurs, fall back to original opus_encode
+        return EncodeUnprocessed(st, pcm, pcmFloat, frame_size, data, max_data_bytes);
+    }
+}
+
+// Hand the packet that goes out to the recorder. Returns the length unchanged: the
+// voice engine sends exactly what opus_encode returns, every call.
+static opus_int32 FinishPacket(OpusEncoder* st, opus_int32 length, int frame_size,
+    unsigned char* data, opus_int32 max_data_bytes) {
+    if (!st || !data || frame_size <= 0 || length <= 0 || !packetRecorder.isRecording()) {
+        return length;
+    }
+    EncoderContext* ctx = AcquireEncoderContext(st);
+    if (!ctx) {
+        return length;
+    }
+    opus_int32 sampleRate = ctx->ctl.getSampleRate(st, 48000);
+
+    // Only copies into the recorder's ring, its writer thread does the file work
+    if (ctx->recordPreSkip < 0) {
+        opus_int32 lookahead = 0;
+        opus_encoder_ctl(st, OPUS_GET_LOOKAHEAD(&lookahead));
+        ctx->recordPreSkip = (int)((long long)lookahead * 48000 / sampleRate);
+    }
+    packetRecorder.push(st, data, length, ctx->ctl.getChannels(st, 2), (int)sampleRate, ctx->recordPreSkip);
+    return length;
+}
+
+// Hook function for audio callbacks - this is what would be connected to the voice processing
+extern "C" opus_int32 custom_opus_encode(OpusEncoder* st, const opus_int16* pcm, int frame_size,
+    unsigned char* data, opus_int32 max_data_bytes) {
+    opus_int32 length = EncodeWithEffects(st, pcm, nullptr, frame_size, data, max_data_bytes);
+    return FinishPacket(st, length, frame_size, data, max_data_bytes);
+}
+
+// Float entry point, for voice modules that hand the encoder float frames
+extern "C" opus_int32 custom_opus_encode_float(OpusEncoder* st, const float* pcm, int frame_size,
+    unsigned char* data, opus_int32 max_data_bytes) {
+    opus_int32 length = EncodeWithEffects(st, nullptr, pcm, frame_size, data, max_data_bytes);
+    return FinishPacket(st, length, frame_size, data, max_data_bytes);
+}
+
+// Multistream frame as the host passed it
+static int MultistreamEncodeUnprocessed(OpusMSEncoder* st, const opus_int16* pcm, const float* pcmFloat, int frame_size,
+    unsigned char* data, opus_int32 max_data_bytes) {
+    if (pcmFloat) {
+        return opus_multistream_encode_float(st, pcmFloat, frame_size, data, max_data_bytes);
+    }
+    return opus_multistream_encode(st, pcm, frame_size, data, max_data_bytes);
+}
+
+// Input channels and sample rate of a multistream encoder, from its per-stream encoders.
+// Assumes no input channel is dropped by the mapping, true for the surround layouts.
+static void QueryMultistreamFormat(OpusMSEncoder* st, int& channels, int& sampleRate) {
+    channels = 0;
+    sampleRate = 0;
+    for (int stream = 0; stream < 255; stream++) {
+        OpusEncoder* encoder = nullptr;
+        // OPUS_MULTISTREAM_GET_ENCODER_STATE_REQUEST (5120), fails past the last stream
+        if (opus_multistream_encoder_ctl(st, 5120, (opus_int32)stream, &encoder) != OPUS_OK || !encoder) {
+            break;
+        }
+
+        opus_int32 value = 0;
+        if (opus_encoder_ctl(encoder, 1029, &value) == OPUS_OK) {
+            channels += (int)value;
+        }
+        if (stream == 0 && opus_encoder_ctl(encoder, 4029, &value) == OPUS_OK) {
+            sampleRate = (int)value;
+        }
+    }
+}
+
+// Everything one multistream encoder owns: its format, the full interleaved frame and a
+// chain per channel group, indexed like ChannelLayout::groups (the LFE's goes unused).
+// Kept in a map of their own so surround streams never take voice encoder slots.
+struct MultistreamContext {
+    int channels = 0;
+    int sampleRate = 0;
+    float frame[MAX_FRAME_SAMPLES];
+    EncoderContext groups[ChannelLayout::MAX_GROUPS];
+};
+
+// Go Live surround runs a single multistream encoder, two covers a reconnect. There is
+// no destroy hook for them, idle ones are evicted like the voice encoders.
+LockFreePointerMap<MultistreamContext, 2> multistreamContexts;
+
+static MultistreamContext* AcquireMultistreamContext(const OpusMSEncoder* st) {
+    unsigned long long now = GetTickCount64();
+    if (MultistreamContext* ctx = multistreamContexts.find(st, now)) {
+        return ctx;
+    }
+
+    multistreamContexts.evictStale(now, ENCODER_CONTEXT_IDLE_MS);
+    return multistreamContexts.findOrInsert(st, now);
+}
+
+// Shared body of the multistream hooks: every channel group (front pair, center, side
+// and rear pairs) runs through its own effect chain, the LFE is left alone. A frame
+// is either processed as a whole or passed through untouched.
+static int MultistreamEncodeWithEffects(OpusMSEncoder* st, const opus_int16* pcm, const float* pcmFloat, int frame_size,
+    unsigned char* data, opus_int32 max_data_bytes) {
+    if (!surroundEffectsEnabled || !st || (!pcm && !pcmFloat) || !data || frame_size <= 0 || max_data_bytes <= 0) {
+        return MultistreamEncodeUnprocessed(st, pcm, pcmFloat, frame_size, data, max_data_bytes);
+    }
+
+    MultistreamContext* stream = AcquireMultistreamContext(st);
+    if (!stream) {
+        return MultistreamEncodeUnprocessed(st, pcm, pcmFloat, frame_size, data, max_data_bytes);
+    }
+    if (!stream->channels) {
+        QueryMultistreamFormat(st, stream->channels, stream->sampleRate);
+    }
+
+    int channels = stream->channels;
+    ChannelLayout layout = MakeChannelLayout(channels);
+    if (layout.groupCount == 0 || stream->sampleRate <= 0 || frame_size * channels > MAX_FRAME_SAMPLES) {
+        return MultistreamEncodeUnprocessed(st, pcm, pcmFloat, frame_size, data, max_data_bytes);
+    }
+
+    try {
+        // Full interleaved frame in float
+        float* frame = stream->frame;
+        int total_samples = frame_size * channels;
+        if (pcmFloat) {
+            memcpy(frame, pcmFloat, total_samples * sizeof(float));
+        }
+        else {
+            ConvertInt16ToFloat(pcm, frame, total_samples);
+        }
+
+        EffectSettings fx = CaptureEffectSettings();
+        for (int g = 0; g < layout.groupCount; g++) {
+            const ChannelGroup& group = layout.groups[g];
+            if (group.lfe) continue;
+
+            EncoderContext& ctx = stream->groups[g];
+            ConfigureAudioChain(ctx, stream->sampleRate, group.count);
+            GatherChannelGroup(frame, channels, group, ctx.floatFrame, frame_size);
+            ApplyAudioEffects(ctx, fx, ctx.floatFrame, frame_size, group.count);
+            ScatterChannelGroup(ctx.floatFrame, group, frame, channels, frame_size);
+        }
+
+        return opus_multistream_encode_float(st, frame, frame_size, data, max_data_bytes);
+    }
+    catch (...) {
+        return MultistreamEncodeUnprocessed(st, pcm, pcmFloat, frame_size, data, max_data_bytes);
+    }
+}
+
+// Multistream encoder hooks, used for surround audio
+extern "C" int custom_opus_multistream_encode(OpusMSEncoder* st, const opus_int16* pcm, int frame_size,
+    unsigned char* data, opus_int32 max_data_bytes) {
+    return MultistreamEncodeWithEffects(st, pcm, nullptr, frame_size, data, max_data_bytes);
+}
+
+extern "C" int custom_opus_multistream_encode_float(OpusMSEncoder* st, const float* pcm, int frame_size,
+    unsigned char* data, opus_int32 max_data_bytes) {
+    return MultistreamEncodeWithEffects(st, nullptr, pcm, frame_size, data, max_data_bytes);
+}
+
+const char* const EFFECT_PRESET_NAMES[(int)EffectPreset::Count] = { "Bypass", "Current", "Voice", "Full" };
 
-    // Using OPUS_GET_CHANNELS_REQUEST (1029) directly since the macro might not be available
-    opus_int32 channels_i32 = 0;
-    if (opus_encoder_ctl(st, 1029, &channels_i32) == OPUS_OK) {
-        channels = (int)channels_i32;
+// Settings of an effect matrix preset. Current is the UI as it is, the others start
+// from it and switch whole stages on or off.
+static EffectSettings MakePresetSettings(EffectPreset preset) {
+    EffectSettings fx = CaptureEffectSettings();
+    if (preset == EffectPreset::Current) {
+        return fx;
     }
 
-    try {
-        // Set the bitrate using OPUS_SET_BITRATE_REQUEST (4002)
-        // Make sure bitrateValue is within valid range
-        int bitrate = static_cast<int>(bitrateValue);
-        bitrate = Max(16000, Min(bitrate, 510000)); // Ensure value is within valid range
-        opus_encoder_ctl(st, 4002, bitrate); // Set bitrate using Opus control interface
-
-        // Set the channel mode (mono/stereo) using OPUS_SET_FORCE_CHANNELS (4022)
-        // Convert from UI index (0 or 1) to actual channel count (1 or 2)
-        int actualChannels = audioChannelMode + 1;
-        opus_encoder_ctl(st, 4022, actualChannels);
+    if (preset == EffectPreset::Bypass || preset == EffectPreset::Voice) {
+        // Nothing but the EQ mix, limiter and meters
+        fx.bassEQ = fx.midEQ = fx.highEQ = 0.0f;
+        fx.Gain = fx.ExpGain = fx.VunitsGain = 1.0f;
+        fx.bassBoostEnabled = false;
+        fx.reverbEnabled = false;
+        fx.energyEnabled = false;
+        fx.compEnabled = false;
+        fx.agcEnabled = false;
+        fx.panningValue = 0.0f;
+        fx.inHeadLeft = fx.inHeadRight = false;
+    }
+    if (preset == EffectPreset::Voice) {
+        // Speech dynamics only
+        fx.compEnabled = true;
+        fx.agcEnabled = true;
+    }
+    if (preset == EffectPreset::Full) {
+        // Every stage at once, the worst case for CPU
+        fx.bassBoostEnabled = true;
+        fx.reverbEnabled = true;
+        fx.energyEnabled = true;
+        fx.compEnabled = true;
+        fx.agcEnabled = true;
+    }
+    return fx;
+}
 
-        // Check if audio is silent or near-silent
-        int total_samples = frame_size * channels;
+// Effect chain of one matrix run, never registered with the live streams
+struct PipelineSession {
+    EncoderContext ctx;
+    EffectSettings fx;
+};
 
-        // Use RMS (Root Mean Square) to better detect silence
-        double rms = 0.0;
-        for (int i = 0; i < total_samples; i++) {
-            rms += static_cast<double>(pcm[i]) * pcm[i];
-        }
-        rms = sqrt(rms / total_samples);
+PipelineSession* CreatePipelineSession(EffectPreset preset, int sampleRate, int channels) {
+    PipelineSession* session = new (std::nothrow) PipelineSession();
+    if (!session) {
+        return nullptr;
+    }
+    session->fx = MakePresetSettings(preset);
+    ConfigureAudioChain(session->ctx, sampleRate, channels);
+    return session;
+}
 
-        // Silence detection with a somewhat higher threshold to catch very quiet audio too
-        // This handles both explicit muting and natural silences
-        bool is_silent = (rms < 30.0);
-
-        // Store previous frame's silence state to detect transitions
-        static bool was_silent_prev_frame = false;
-        // Store our generated noise pattern to ensure smooth transitions
-        static opus_int16* prev_noise_buffer = nullptr;
-        static int prev_noise_size = 0;
-
-        // If we're transitioning from sound to silence, we need to be extra careful
-        bool is_transition = (is_silent != was_silent_prev_frame);
-
-        // Handle all cases of silence - both explicit muting and natural pauses
-        if (is_silent) {
-            // Allocate or reuse noise buffer
-            if (!prev_noise_buffer || prev_noise_size != total_samples) {
-                // Clean up old buffer if it exists but size doesn't match
-                if (prev_noise_buffer) {
-                    delete[] prev_noise_buffer;
-                }
+void DestroyPipelineSession(PipelineSession* session) {
+    delete session;
+}
 
-                // Create new buffer
-                prev_noise_buffer = new opus_int16[total_samples];
-                prev_noise_size = total_samples;
-
-                // Initialize with fresh noise pattern
-                srand(static_cast<unsigned int>(time(nullptr)));
-                for (int i = 0; i < total_samples; i++) {
-                    // Extremely low amplitude noise (15-25 range) - just enough to keep the encoder happy
-                    prev_noise_buffer[i] = 15 + (rand() % 10);
-                    if (rand() % 2) {
-                        prev_noise_buffer[i] = -prev_noise_buffer[i];
-                    }
-                }
-            }
+void ProcessPipelineFrame(PipelineSession* session, float* pcm, int frameSize) {
+    ApplyAudioEffects(session->ctx, session->fx, pcm, frameSize, session->ctx.chain.channels);
+}
 
-            // Create a copy for this frame (so we can modify it safely)
-            opus_int16* noise_pcm = new opus_int16[total_samples];
-            if (!noise_pcm) {
-                return opus_encode(st, pcm, frame_size, data, max_data_bytes);
-            }
+// Receive side: everything one incoming voice owns. Each remote user has a decoder of
+// their own, so keying by decoder keeps one user's compressor and limiter state away
+// from everyone else's.
+struct DecoderContext {
+    // Format the chain is configured for, checked against the decoder every frame
+    int sampleRate = 0;
+    int channels = 0;
+
+    // EQ bands per channel, in series: low shelf, peak, high shelf
+    BandPassFilter bassFilter[2], midFilter[2], highFilter[2];
+
+    // Settings the EQ coefficients were computed for, NaN forces the first update
+    float eqBassDb = NAN;
+    float eqMidDb = NAN;
+    float eqTrebleDb = NAN;
+    int eqSampleRate = 0;
+
+    Compressor compressor;
+    TruePeakDetector limiterSidechain;
+    PeakLimiter limiter;
+    bool prevCompEnabled = false;
+    float gain = 1.0f;
+
+    // Per-voice level and position, set from the Decoder tab
+    std::atomic<float> userGainDb{ 0.0f };
+    std::atomic<float> userPan{ 0.0f };
+    std::atomic<float> peak{ 0.0f };    // Last frame's output peak, for the voice list
+
+    // Working buffers, part of the context so a frame never allocates
+    float frame[MAX_FRAME_SAMPLES];
+    float truePeakLevels[MAX_FRAME_SAMPLES];
+};
 
-            // If we're transitioning from sound to silence, blend the real signal with our noise
-            if (is_transition && was_silent_prev_frame == false) {
-                // Crossfade smoothly
-                for (int i = 0; i < total_samples; i++) {
-                    // Gradually fade from real signal to noise over the frame
-                    float mix_ratio = static_cast<float>(i) / total_samples;
-                    noise_pcm[i] = static_cast<opus_int16>(
-                        pcm[i] * (1.0f - mix_ratio) + prev_noise_buffer[i] * mix_ratio
-                        );
-                }
-            }
-            else {
-                // Just use our existing noise pattern with slight variations
-                for (int i = 0; i < total_samples; i++) {
-                    // Add tiny random variations to prevent encoder from getting "stuck"
-                    int variation = (rand() % 5) - 2; // -2 to +2 variation
-                    noise_pcm[i] = prev_noise_buffer[i] + variation;
-                }
-            }
+// Incoming voices, a busy channel has far more of them than we have encoders. Like the
+// encoder contexts, all 128 are built with the map and recycled in place, so the decode
+// thread never allocates or frees one.
+static constexpr unsigned long long DECODER_CONTEXT_IDLE_MS = 30000;
+LockFreePointerMap<DecoderContext, 128> decoderContexts;
 
-            // Try encoding with the noise pattern
-            opus_int32 result = opus_encode(st, noise_pcm, frame_size, data, max_data_bytes);
+DecoderContext* AcquireDecoderContext(const OpusDecoder* st) {
+    unsigned long long now = GetTickCount64();
+    if (DecoderContext* ctx = decoderContexts.find(st, now)) {
+        return ctx;
+    }
 
-            // Save the noise buffer for next time if needed
-            memcpy(prev_noise_buffer, noise_pcm, total_samples * sizeof(opus_int16));
-            delete[] noise_pcm;
+    // New voice: clean up after decoders that went away before making room for it
+    decoderContexts.evictStale(now, DECODER_CONTEXT_IDLE_MS);
+    return decoderContexts.findOrInsert(st, now);
+}
 
-            // If primary approach fails, try fallback strategies
-            if (result < 0) {
-                // Strategy 2: Try with DTX enabled
-                opus_encoder_ctl(st, 4016, 1); // OPUS_SET_DTX(1)
-                result = opus_encode(st, pcm, frame_size, data, max_data_bytes);
-                opus_encoder_ctl(st, 4016, 0); // OPUS_SET_DTX(0)
+// Channels and sample rate of a decoder. There is no ctl for the channel count, so it
+// comes from the first fields of libopus' OpusDecoder (celt offset, silk offset,
+// channels, Fs - unchanged since 1.0), checked against OPUS_GET_SAMPLE_RATE.
+static bool QueryDecoderFormat(OpusDecoder* st, int& channels, int& sampleRate) {
+    opus_int32 rate = 0;
+    if (opus_decoder_ctl(st, 4029, &rate) != OPUS_OK) { // OPUS_GET_SAMPLE_RATE
+        return false;
+    }
+    const int* fields = reinterpret_cast<const int*>(st);
+    if (fields[3] != rate || (fields[2] != 1 && fields[2] != 2)) {
+        return false;
+    }
+    channels = fields[2];
+    sampleRate = (int)rate;
+    return true;
+}
 
-                if (result < 0) {
-                    // Strategy 3: Try with constant DC values
-                    opus_int16* dc_pcm = new opus_int16[total_samples];
-                    if (!dc_pcm) {
-                        return opus_encode(st, pcm, frame_size, data, max_data_bytes);
-                    }
+// Retune one voice's chain, only does work when the format changed
+static void ConfigureDecoderChain(DecoderContext& ctx, int sampleRate, int channels) {
+    if (sampleRate == ctx.sampleRate && channels == ctx.channels) {
+        return;
+    }
+    ctx.sampleRate = sampleRate;
+    ctx.channels = channels;
 
-                    for (int i = 0; i < total_samples; i++) {
-                        dc_pcm[i] = 64; // Very small constant value
-                    }
+    for (int ch = 0; ch < 2; ch++) {
+        ctx.bassFilter[ch].reset();
+        ctx.midFilter[ch].reset();
+        ctx.highFilter[ch].reset();
+    }
+    ctx.compressor.reset();
+    ctx.limiter.reset();
+}
 
-                    result = opus_encode(st, dc_pcm, frame_size, data, max_data_bytes);
-                    delete[] dc_pcm;
-                }
-            }
+// Receive EQ corners, the same regions the send side's bands cover
+static constexpr float DECODER_BASS_HZ = 200.0f;
+static constexpr float DECODER_MID_HZ = 1000.0f;
+static constexpr float DECODER_MID_Q = 0.7f;
+static constexpr float DECODER_TREBLE_HZ = 4500.0f;
 
-            // Update silence tracking
-            was_silent_prev_frame = true;
-            return result;
-        }
-        else {
-            // Normal audio processing
+// Audio EQ Cookbook (RBJ) designs with a shelf slope of 1. gainDb is the real gain of
+// the shelf or the peak, and 0 dB is an exact passthrough.
+static BiquadDesign NormalizeBiquad(float b0, float b1, float b2, float a0, float a1, float a2) {
+    return { b0 / a0, b1 / a0, b2 / a0, a1 / a0, a2 / a0, 1.0f };
+}
 
-            // If transitioning from silence to sound, do a gentle fade-in
-            if (is_transition && was_silent_prev_frame && prev_noise_buffer) {
-                // Create a temp buffer for the crossfade
-                opus_int16* transition_pcm = new opus_int16[total_samples];
-                if (transition_pcm) {
-                    // Crossfade from noise to real audio
-                    for (int i = 0; i < total_samples; i++) {
-                        float mix_ratio = static_cast<float>(i) / total_samples;
-                        transition_pcm[i] = static_cast<opus_int16>(
-                            prev_noise_buffer[i] * (1.0f - mix_ratio) + pcm[i] * mix_ratio
-                            );
-                    }
+static BiquadDesign LowShelfDesign(float freq, float gainDb, int sampleRate) {
+    float A = powf(10.0f, gainDb / 40.0f);
+    float w0 = 2.0f * MY_PI * Min(freq, 0.45f * sampleRate) / sampleRate;
+    float c = cosf(w0);
+    float k = 2.0f * sqrtf(A) * sinf(w0) * 0.70710678f;  // 2 * sqrt(A) * alpha
+    return NormalizeBiquad(
+        A * ((A + 1.0f) - (A - 1.0f) * c + k),
+        2.0f * A * ((A - 1.0f) - (A + 1.0f) * c),
+        A * ((A + 1.0f) - (A - 1.0f) * c - k),
+        (A + 1.0f) + (A - 1.0f) * c + k,
+        -2.0f * ((A - 1.0f) + (A + 1.0f) * c),
+        (A + 1.0f) + (A - 1.0f) * c - k);
+}
 
-                    // Process this crossfaded audio instead of the original
-                    float* audioBuffer = new float[frame_size * channels];
-                    if (audioBuffer) {
-                        // Convert to float for processing
-                        for (int i = 0; i < total_samples; i++) {
-                            audioBuffer[i] = transition_pcm[i] / 32768.0f;
-                        }
+static BiquadDesign PeakingDesign(float freq, float q, float gainDb, int sampleRate) {
+    float A = powf(10.0f, gainDb / 40.0f);
+    float w0 = 2.0f * MY_PI * Min(freq, 0.45f * sampleRate) / sampleRate;
+    float c = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    return NormalizeBiquad(1.0f + alpha * A, -2.0f * c, 1.0f - alpha * A, 1.0f + alpha / A, -2.0f * c, 1.0f - alpha / A);
+}
 
-                        // Apply effects
-                        ApplyAudioEffects(audioBuffer, frame_size, channels);
+static BiquadDesign HighShelfDesign(float freq, float gainDb, int sampleRate) {
+    float A = powf(10.0f, gainDb / 40.0f);
+    float w0 = 2.0f * MY_PI * Min(freq, 0.45f * sampleRate) / sampleRate;
+    float c = cosf(w0);
+    float k = 2.0f * sqrtf(A) * sinf(w0) * 0.70710678f;
+    return NormalizeBiquad(
+        A * ((A + 1.0f) + (A - 1.0f) * c + k),
+        -2.0f * A * ((A - 1.0f) + (A + 1.0f) * c),
+        A * ((A + 1.0f) + (A - 1.0f) * c - k),
+        (A + 1.0f) - (A - 1.0f) * c + k,
+        2.0f * ((A - 1.0f) - (A + 1.0f) * c),
+        (A + 1.0f) - (A - 1.0f) * c - k);
+}
 
-                        // Convert back to int16
-                        opus_int16* processedPcm = new opus_int16[total_samples];
-                        if (processedPcm) {
-                            for (int i = 0; i < total_samples; i++) {
-                                processedPcm[i] = (opus_int16)(audioBuffer[i] * 32767.0f);
-                            }
+// Load coefficients without clearing the history, so moving a slider doesn't click
+static void SetBiquadCoefficients(BandPassFilter& filter, const BiquadDesign& d) {
+    filter.a0 = d.a0;
+    filter.a1 = d.a1;
+    filter.a2 = d.a2;
+    filter.b1 = d.b1;
+    filter.b2 = d.b2;
+    filter.gain = d.gain;
+}
 
-                            // Encode processed audio
-                            opus_int32 result = opus_encode(st, processedPcm, frame_size, data, max_data_bytes);
+// Recompute the EQ when a slider or the decoder's rate changed
+static void UpdateDecoderEq(DecoderContext& ctx) {
+    float bassDb = decoderBassDb;
+    float midDb = decoderMidDb;
+    float trebleDb = decoderTrebleDb;
+    if (bassDb == ctx.eqBassDb && midDb == ctx.eqMidDb && trebleDb == ctx.eqTrebleDb && ctx.sampleRate == ctx.eqSampleRate) {
+        return;
+    }
+    ctx.eqBassDb = bassDb;
+    ctx.eqMidDb = midDb;
+    ctx.eqTrebleDb = trebleDb;
+    ctx.eqSampleRate = ctx.sampleRate;
+
+    BiquadDesign bass = LowShelfDesign(DECODER_BASS_HZ, bassDb, ctx.sampleRate);
+    BiquadDesign mid = PeakingDesign(DECODER_MID_HZ, DECODER_MID_Q, midDb, ctx.sampleRate);
+    BiquadDesign treble = HighShelfDesign(DECODER_TREBLE_HZ, trebleDb, ctx.sampleRate);
+    for (int ch = 0; ch < 2; ch++) {
+        SetBiquadCoefficients(ctx.bassFilter[ch], bass);
+        SetBiquadCoefficients(ctx.midFilter[ch], mid);
+        SetBiquadCoefficients(ctx.highFilter[ch], treble);
+    }
+}
 
-                            // Clean up
-                            delete[] processedPcm;
-                            delete[] audioBuffer;
-                            delete[] transition_pcm;
+// Gain, EQ, compressor and limiter on one decoded frame
+static void ProcessDecodedFrame(DecoderContext& ctx, float* buffer, int frames) {
+    int channels = ctx.channels;
 
-                            // Update silence tracking
-                            was_silent_prev_frame = false;
-                            return result;
-                        }
-                        delete[] audioBuffer;
-                    }
-                    delete[] transition_pcm;
-                }
-                // If transition handling failed, continue with normal processing
-            }
+    // Gain ramps over the frame so slider moves don't click
+    float targetGain = powf(10.0f, decoderGainDb / 20.0f);
+    float gainStep = (targetGain - ctx.gain) / frames;
 
-            // Standard audio processing path
-            float* audioBuffer = new float[frame_size * channels];
-            if (!audioBuffer) {
-                // Memory allocation failed, fall back to original
-                was_silent_prev_frame = false;
-                return opus_encode(st, pcm, frame_size, data, max_data_bytes);
-            }
+    UpdateDecoderEq(ctx);
 
-            // Convert input pcm to float for processing
-            for (int i = 0; i < total_samples; i++) {
-                audioBuffer[i] = pcm[i] / 32768.0f;
-            }
+    for (int i = 0; i < frames; i++) {
+        ctx.gain += gainStep;
+        for (int ch = 0; ch < channels; ch++) {
+            float sample = buffer[i * channels + ch] * ctx.gain;
+            sample = ctx.highFilter[ch].process(ctx.midFilter[ch].process(ctx.bassFilter[ch].process(sample)));
+            buffer[i * channels + ch] = sample;
+        }
+    }
+    ctx.gain = targetGain;
+
+    // Compressor, starting from no reduction every time it gets switched on
+    if (decoderCompEnabled) {
+        ctx.compressor.configure(ctx.sampleRate, channels);
+        ctx.compressor.setParams(decoderCompThresholdDb, decoderCompRatio, 6.0f, 5.0f, 150.0f, 0.0f, true);
+        if (!ctx.prevCompEnabled) {
+            ctx.compressor.reset();
+        }
+        ctx.compressor.process(buffer, frames);
+    }
+    ctx.prevCompEnabled = decoderCompEnabled;
+
+    // This voice's own gain and pan, before the limiter so a boosted voice can't clip
+    float left, right;
+    PanGains(ctx.userGainDb.load(std::memory_order_relaxed), ctx.userPan.load(std::memory_order_relaxed), left, right);
+    ApplyGainPan(buffer, frames, channels, left, right);
+
+    // Brickwall limiter last, so no voice can come out clipped
+    ctx.limiterSidechain.configure(channels);
+    ctx.limiterSidechain.process(buffer, frames, ctx.truePeakLevels);
+    ctx.limiter.configure(ctx.sampleRate, channels, PeakLimiter::MIN_LOOKAHEAD_MS);
+    ctx.limiter.setSidechainLatency(TruePeakDetector::LATENCY);
+    ctx.limiter.process(buffer, frames, ctx.truePeakLevels);
+}
 
-            // Apply our custom effects
-            ApplyAudioEffects(audioBuffer, frame_size, channels);
-
-            // Convert back to int16
-            opus_int16* processedPcm = new opus_int16[total_samples];
-            if (!processedPcm) {
-                delete[] audioBuffer;
-                was_silent_prev_frame = false;
-                return opus_encode(st, pcm, frame_size, data, max_data_bytes);
-            }
+// Original opus_decode, the hook decodes through it and processes the result
+int (*original_opus_decode)(OpusDecoder* st, const unsigned char* data, opus_int32 len, opus_int16* pcm,
+    int frame_size, int decode_fec) = nullptr;
 
-            for (int i = 0; i < total_samples; i++) {
-                processedPcm[i] = (opus_int16)(audioBuffer[i] * 32767.0f);
-            }
+extern "C" int custom_opus_decode(OpusDecoder* st, const unsigned char* data, opus_int32 len, opus_int16* pcm,
+    int frame_size, int decode_fec) {
+    int samples = original_opus_decode(st, data, len, pcm, frame_size, decode_fec);
 
-            // Call original opus encode with our processed audio
-            opus_int32 result = opus_encode(st, processedPcm, frame_size, data, max_data_bytes);
+    // Concealed (PLC) and FEC frames go through the chain too, so its state stays continuous
+    if (samples <= 0 || !decoderEffectsEnabled || !st || !pcm) {
+        return samples;
+    }
 
-            // Clean up
-            delete[] audioBuffer;
-            delete[] processedPcm;
+    DecoderContext* ctx = AcquireDecoderContext(st);
+    if (!ctx) {
+        return samples;
+    }
 
-            // Update silence tracking
-            was_silent_prev_frame = false;
-            return result;
+    try {
+        // Read every frame: a new decoder can take a freed one's address, and with it
+        // that decoder's context, so a remembered format could be the wrong one
+        int channels = 0;
+        int sampleRate = 0;
+        if (!QueryDecoderFormat(st, channels, sampleRate)) {
+            return samples;
+        }
+        if (samples * channels > MAX_FRAME_SAMPLES) {
+            return samples;
         }
+        ConfigureDecoderChain(*ctx, sampleRate, channels);
+
+        ConvertInt16ToFloat(pcm, ctx->frame, samples * channels);
+        ProcessDecodedFrame(*ctx, ctx->frame, samples);
+        ctx->peak.store(PeakAbs(ctx->frame, samples * channels), std::memory_order_relaxed);
+        ConvertFloatToInt16(ctx->frame, pcm, samples * channels);
     }
     catch (...) {
-        // If any exception occurs, fall back to original opus_encode
-        return opus_encode(st, pcm, frame_size, data, max_data_bytes);
+        // The decoded audio is already in pcm, leave it as it is
     }
+    return samples;
 }
 
 // Initialize and start the UI thread
@@ -2514,9 +3812,6 @@ namespace utilities {
             // Make tab bar separators more visible
             style.TabBarBorderSize = 1.0f;
 
-            // Initialize our EQ filters
-            InitEQFilters();
-
             // Modern theme with pure colors (no grey effects)
             ImVec4* colors = style.Colors;
             colors[ImGuiCol_Text] = ImVec4(1.00f, 1.00f, 1.00f, 1.00f);
@@ -2739,15 +4034,85 @@ namespace utilities {
 
                             // And similarly for other SectionHeader calls
 
-                            DrawSlider("Gain", &Gain, 1.0f, 90.0f, "On dB checker its ~20dB");
-                            DrawSlider("Rage Gain", &ExpGain, 1.0f, 120.0f, "On dB checker its ~60-65dB");
-                            DrawSlider("vUnits Gain", &VunitsGain, 1.0f, 5100000000.0f, "Increase = more clear audio");
-
-                            // Energy control - centered style
+                            // Centered layout shared by the encoder controls
                             float encoderControlWidth = ImGui::GetWindowWidth();
                             float encoderContentWidth = encoderControlWidth * 0.8f;
                             float encoderLeftMargin = (encoderControlWidth - encoderContentWidth) * 0.5f;
 
+                            // Auto gain takes over from the gain sliders while enabled
+                            ImGui::SetCursorPosX(encoderLeftMargin + encoderContentWidth / 2 - 60);
+                            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
+                            ImGui::Checkbox("Auto Gain", &agcEnabled);
+                            ImGui::PopStyleVar();
+
+                            if (agcEnabled) {
+                                DrawSlider("Target", &agcTargetLufs, -40.0f, -5.0f, "Loudness to aim for in LUFS");
+                                DrawSlider("Attack", &agcAttackMs, 5.0f, 500.0f, "How fast gain goes down on louder input (ms)");
+                                DrawSlider("Release", &agcReleaseMs, 100.0f, 5000.0f, "How fast gain comes back up on quieter input (ms)");
+                                DrawSlider("Hold", &agcHoldMs, 0.0f, 2000.0f, "Wait after a reduction before raising gain again (ms)");
+
+                                char agcGainText[32];
+                                snprintf(agcGainText, sizeof(agcGainText), "Auto Gain %+.1f dB", meterDisplay.agcGainDb.load(std::memory_order_relaxed));
+                                ImGui::SetCursorPosX((encoderControlWidth - ImGui::CalcTextSize(agcGainText).x) * 0.5f);
+                                ImGui::TextUnformatted(agcGainText);
+                            }
+                            else {
+                                DrawSlider("Gain", &Gain, 1.0f, 90.0f, "On dB checker its ~20dB");
+                                DrawSlider("Rage Gain", &ExpGain, 1.0f, 120.0f, "On dB checker its ~60-65dB");
+                                DrawSlider("vUnits Gain", &VunitsGain, 1.0f, 5100000000.0f, "Increase = more clear audio");
+                            }
+                            // Compressor between the gain stage and auto gain
+                            ImGui::SetCursorPosX(encoderLeftMargin + encoderContentWidth / 2 - 60);
+                            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
+                            ImGui::Checkbox("Compressor", &compEnabled);
+                            ImGui::PopStyleVar();
+
+                            if (compEnabled) {
+                                DrawSlider("Threshold", &compThresholdDb, -60.0f, 0.0f, "Level where compression starts (dBFS)");
+                                DrawSlider("Ratio", &compRatio, 1.0f, 20.0f, "Input dB over threshold per output dB");
+                                DrawSlider("Knee", &compKneeDb, 0.0f, 24.0f, "Width of the soft knee around the threshold (dB)");
+                                DrawSlider("Comp Attack", &compAttackMs, 0.5f, 200.0f, "How fast compression kicks in (ms)");
+                                DrawSlider("Comp Release", &compReleaseMs, 10.0f, 2000.0f, "How fast compression lets go (ms)");
+                                DrawSlider("Makeup", &compMakeupDb, 0.0f, 24.0f, "Gain added after compression (dB)");
+
+                                // Stereo link only matters when sending two channels
+                                if (audioChannelMode == 1) {
+                                    ImGui::SetCursorPosX(encoderLeftMargin + encoderContentWidth / 2 - 60);
+                                    ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
+                                    ImGui::Checkbox("Stereo Link", &compLinked);
+                                    ImGui::PopStyleVar();
+                                    if (ImGui::IsItemHovered()) {
+                                        ImGui::BeginTooltip();
+                                        ImGui::TextUnformatted("Compress both channels together to keep the stereo image");
+                                        ImGui::EndTooltip();
+                                    }
+                                }
+
+                                char compReductionText[32];
+                                snprintf(compReductionText, sizeof(compReductionText), "Reduction %.1f dB", meterDisplay.compReductionDb.load(std::memory_order_relaxed));
+                                ImGui::SetCursorPosX((encoderControlWidth - ImGui::CalcTextSize(compReductionText).x) * 0.5f);
+                                ImGui::TextUnformatted(compReductionText);
+                            }
+                            DrawSlider("Lookahead", &limiterLookaheadMs, PeakLimiter::MIN_LOOKAHEAD_MS, PeakLimiter::MAX_LOOKAHEAD_MS, "Limiter look-ahead in ms (longer = smoother peaks, more delay)");
+
+                            // Output true-peak meter, -60 to 0 dBTP
+                            float truePeakDb = meterDisplay.truePeakDb.load(std::memory_order_relaxed);
+                            char truePeakText[32];
+                            snprintf(truePeakText, sizeof(truePeakText), "True Peak %.1f dBTP", truePeakDb);
+
+                            ImGui::SetCursorPosX(encoderLeftMargin);
+                            ImGui::ProgressBar(Max(0.0f, Min(1.0f, (truePeakDb + 60.0f) / 60.0f)), ImVec2(encoderContentWidth, 0.0f), truePeakText);
+
+                            // Loudness readout with a reset for the integrated value
+                            const char* loudnessText = FormatLoudnessText(meterDisplay.momentaryLufs.load(std::memory_order_relaxed), meterDisplay.shortTermLufs.load(std::memory_order_relaxed), meterDisplay.integratedLufs.load(std::memory_order_relaxed));
+                            float loudnessWidth = ImGui::CalcTextSize(loudnessText).x + ImGui::CalcTextSize("Reset").x + 20.0f;
+                            ImGui::SetCursorPosX((encoderControlWidth - loudnessWidth) * 0.5f);
+                            ImGui::TextUnformatted(loudnessText);
+                            ImGui::SameLine();
+                            if (ImGui::SmallButton("Reset##loudness")) {
+                                loudnessResetGeneration.fetch_add(1, std::memory_order_relaxed);
+                            }
+
                             // Center the Energy checkbox
                             ImGui::SetCursorPosX(encoderLeftMargin + encoderContentWidth / 2 - 60);
                             ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
@@ -2764,13 +4129,140 @@ namespace utilities {
                             if (energyEnabled) {
                                 // Use DrawSlider for consistent styling
                                 DrawSlider("Energy Value", &energyValue, 100000.0f, 1000000.0f, "Energy effect level");
+                                DrawSlider("Energy Rate", &energyLfoRate, 0.1f, 10.0f, "Energy modulation speed in Hz");
+
+                                // Modulation waveform
+                                float energyShapeWidth = 160.0f;
+                                ImGui::SetCursorPosX((encoderControlWidth - energyShapeWidth) * 0.5f);
+                                ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 6.0f);
+                                ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(8, 6));
+                                ImGui::PushItemWidth(energyShapeWidth);
+                                if (ImGui::BeginCombo("##EnergyShapeCombo", Lfo::NAMES[energyLfoShape])) {
+                                    for (int i = 0; i < (int)LfoShape::Count; i++) {
+                                        const bool is_selected = (energyLfoShape == i);
+                                        if (ImGui::Selectable(Lfo::NAMES[i], is_selected)) {
+                                            energyLfoShape = i;
+                                        }
+                                        if (is_selected)
+                                            ImGui::SetItemDefaultFocus();
+                                    }
+                                    ImGui::EndCombo();
+                                }
+                                if (ImGui::IsItemHovered()) {
+                                    ImGui::BeginTooltip();
+                                    ImGui::TextUnformatted("Energy modulation waveform");
+                                    ImGui::EndTooltip();
+                                }
+                                ImGui::PopItemWidth();
+                                ImGui::PopStyleVar(2);
+                            }
+
+                            // Soft clipper curve used by the EQ and energy ceilings
+                            float saturatorComboWidth = 160.0f;
+                            ImGui::SetCursorPosX((encoderControlWidth - saturatorComboWidth) * 0.5f);
+                            ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 6.0f);
+                            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(8, 6));
+                            ImGui::PushItemWidth(saturatorComboWidth);
+                            if (ImGui::BeginCombo("##SaturatorCombo", Saturator::NAMES[saturatorType])) {
+                                for (int i = 0; i < (int)SaturatorType::Count; i++) {
+                                    const bool is_selected = (saturatorType == i);
+                                    if (ImGui::Selectable(Saturator::NAMES[i], is_selected)) {
+                                        saturatorType = i;
+                                    }
+                                    if (is_selected)
+                                        ImGui::SetItemDefaultFocus();
+                                }
+                                ImGui::EndCombo();
+                            }
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::BeginTooltip();
+                                ImGui::TextUnformatted("Saturation curve for the EQ and energy ceilings");
+                                ImGui::EndTooltip();
                             }
+                            ImGui::PopItemWidth();
+                            ImGui::PopStyleVar(2);
 
                             DrawAlignedSeparator("Opus Encoder", rgbModeEnabled);
 
                             // Bitrate control section - center style
                             DrawSlider("Bitrate", &bitrateValue, 16000.0f, 510000.0f, "Bitrate change (higher = better quality but more bandwidth)");
 
+                            // In-band FEC, leave it to Discord or force it
+                            float fecComboWidth = 160.0f;
+                            ImGui::SetCursorPosX((encoderControlWidth - fecComboWidth) * 0.5f);
+                            ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 6.0f);
+                            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(8, 6));
+                            ImGui::PushItemWidth(fecComboWidth);
+                            if (ImGui::BeginCombo("##FecCombo", fecModeNames[fecMode])) {
+                                for (int i = 0; i < IM_ARRAYSIZE(fecModeNames); i++) {
+                                    const bool is_selected = (fecMode == i);
+                                    if (ImGui::Selectable(fecModeNames[i], is_selected)) {
+                                        fecMode = i;
+                                    }
+                                    if (is_selected)
+                                        ImGui::SetItemDefaultFocus();
+                                }
+                                ImGui::EndCombo();
+                            }
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::BeginTooltip();
+                                ImGui::TextUnformatted("In-band forward error correction (run the FEC benchmark on the Infos tab to compare)");
+                                ImGui::EndTooltip();
+                            }
+                            ImGui::PopItemWidth();
+                            ImGui::PopStyleVar(2);
+
+                            if (fecMode != 0) {
+                                DrawSlider("Expected Loss", &packetLossPercent, 0.0f, 50.0f, "Packet loss the encoder plans for (%), more means more redundancy");
+                            }
+
+                            // Complexity follows the CPU budget
+                            ImGui::SetCursorPosX(encoderLeftMargin + encoderContentWidth / 2 - 60);
+                            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
+                            ImGui::Checkbox("Adaptive Complexity", &adaptiveComplexityEnabled);
+                            ImGui::PopStyleVar();
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::BeginTooltip();
+                                ImGui::TextUnformatted("Lower the Opus complexity when effects plus encoding take too long");
+                                ImGui::EndTooltip();
+                            }
+
+                            if (adaptiveComplexityEnabled) {
+                                DrawSlider("CPU Budget", &cpuBudgetPercent, 10.0f, 90.0f, "Share of each frame's duration the effects and encoder may use (%)");
+
+                                ImGui::SetCursorPosX(encoderLeftMargin + encoderContentWidth / 2 - 60);
+                                ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
+                                ImGui::Checkbox("Shed Effects", &adaptiveShedEffects);
+                                ImGui::PopStyleVar();
+                                if (ImGui::IsItemHovered()) {
+                                    ImGui::BeginTooltip();
+                                    ImGui::TextUnformatted("Skip the reverb when even the lowest complexity is over budget");
+                                    ImGui::EndTooltip();
+                                }
+                            }
+
+                            // Noise gate in front of the chain, closed frames are sent as DTX
+                            DrawAlignedSeparator("Noise Gate", rgbModeEnabled);
+
+                            DrawSlider("Gate Open", &gateOpenDb, -90.0f, -20.0f, "Level that opens the gate (dBFS)");
+                            DrawSlider("Gate Close", &gateCloseDb, -90.0f, -20.0f, "Level the signal must drop below before the gate closes (dBFS)");
+                            gateCloseDb = Min(gateCloseDb, gateOpenDb);
+                            DrawSlider("Gate Hold", &gateHoldMs, 0.0f, 1000.0f, "How long the gate stays open after the signal drops (ms)");
+                            DrawSlider("Gate Attack", &gateAttackMs, 0.5f, 50.0f, "Fade-in when the gate opens (ms)");
+                            DrawSlider("Gate Release", &gateReleaseMs, 5.0f, 500.0f, "Fade-out when the gate closes (ms)");
+
+                            ImGui::SetCursorPosX(encoderLeftMargin + encoderContentWidth / 2 - 60);
+                            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
+                            ImGui::Checkbox("DTX", &gateDtxEnabled);
+                            ImGui::PopStyleVar();
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::BeginTooltip();
+                                ImGui::TextUnformatted("Send near-empty packets while the gate is closed");
+                                ImGui::EndTooltip();
+                            }
+                            ImGui::SameLine();
+                            ImGui::TextUnformatted(meterDisplay.gateOpen.load(std::memory_order_relaxed) ? "Open" : "Closed");
+
                             // Add channel mode section with proper header
                             DrawAlignedSeparator("Channel Mode", rgbModeEnabled);
 
@@ -2850,6 +4342,17 @@ namespace utilities {
                             ImGui::PopStyleColor(6);
                             ImGui::PopStyleVar(2);
 
+                            // Effects on surround (multistream) encoders, one chain per channel group
+                            ImGui::SetCursorPosX(encoderLeftMargin + encoderContentWidth / 2 - 60);
+                            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
+                            ImGui::Checkbox("Surround Effects", &surroundEffectsEnabled);
+                            ImGui::PopStyleVar();
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::BeginTooltip();
+                                ImGui::TextUnformatted("Apply the effects to 5.1/7.1 streams too (LFE is left untouched)");
+                                ImGui::EndTooltip();
+                            }
+
                             // EQ controls with center title
                             ImGui::Spacing();
                             ImGui::Spacing();
@@ -2868,15 +4371,8 @@ namespace utilities {
                             DrawAlignedSeparator("Effects", rgbModeEnabled);
                             ImGui::SetCursorPosX(encoderLeftMargin + encoderContentWidth / 2 - 80);
                             ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
-                            if (ImGui::Checkbox("Enable Reverb", &reverbEnabled)) {
-                                // When toggling reverb, reinitialize and clear buffers
-                                if (reverbEnabled) {
-                                    reverbProcessor.init(48000, 2);
-                                }
-                                else {
-                                    reverbProcessor.mute();
-                                }
-                            }
+                            // Buffers are cleared on the audio thread when the toggle changes
+                            ImGui::Checkbox("Enable Reverb", &reverbEnabled);
                             ImGui::PopStyleVar();
 
                             // Only show sliders if reverb is enabled
@@ -2896,6 +4392,22 @@ namespace utilities {
                                 DrawSlider("Width", &reverbWidth, 0.0f, 1.0f, "Controls the stereo spread of the reverb effect");
 
                                 ImGui::PopStyleVar();
+
+                                // FP16 delay lines - only offered when the CPU supports F16C
+                                if (CpuFeatures::hasF16C()) {
+                                    ImGui::SetCursorPosX(encoderLeftMargin + encoderContentWidth / 2 - 80);
+                                    ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
+                                    ImGui::Checkbox("Low Memory Reverb", &reverbHalfPrecision);
+                                    ImGui::PopStyleVar();
+
+                                    if (ImGui::IsItemHovered()) {
+                                        ImGui::BeginTooltip();
+                                        ImGui::PushTextWrapPos(ImGui::GetFontSize() * 25.0f);
+                                        ImGui::TextUnformatted("Stores the reverb in half precision, halving its cache use");
+                                        ImGui::PopTextWrapPos();
+                                        ImGui::EndTooltip();
+                                    }
+                                }
                             }
 
                             // Make the separator grey when in mono mode
@@ -3048,9 +4560,64 @@ namespace utilities {
                             ImGui::Checkbox("dB Checker", &Spoofing::Hider);
                             ImGui::PopStyleVar();
 
-                            DrawAlignedSeparator("", rgbModeEnabled);
+                            // Receive chain for every incoming voice
+                            ImGui::SetCursorPosX(decoderLeftMargin + decoderContentWidth / 2 - 60);
+                            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
+                            ImGui::Checkbox("Receive Effects", &decoderEffectsEnabled);
+                            ImGui::PopStyleVar();
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::BeginTooltip();
+                                ImGui::TextUnformatted("Process what you hear: each voice gets its own gain, EQ, compressor and limiter");
+                                ImGui::EndTooltip();
+                            }
+
+                            if (decoderEffectsEnabled) {
+                                DrawSlider("Receive Gain", &decoderGainDb, -24.0f, 24.0f, "Volume of incoming voices (dB)");
+                                DrawSlider("Receive Bass", &decoderBassDb, -12.0f, 12.0f, "Low shelf below 200 Hz on incoming voices (dB)");
+                                DrawSlider("Receive Mid", &decoderMidDb, -12.0f, 12.0f, "Peak around 1 kHz on incoming voices (dB)");
+                                DrawSlider("Receive Treble", &decoderTrebleDb, -12.0f, 12.0f, "High shelf above 4.5 kHz on incoming voices (dB)");
+
+                                ImGui::SetCursorPosX(decoderLeftMargin + decoderContentWidth / 2 - 60);
+                                ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
+                                ImGui::Checkbox("Tame Loud Users", &decoderCompEnabled);
+                                ImGui::PopStyleVar();
+                                if (ImGui::IsItemHovered()) {
+                                    ImGui::BeginTooltip();
+                                    ImGui::TextUnformatted("Compress each voice on its own, so loud users come down without touching quiet ones");
+                                    ImGui::EndTooltip();
+                                }
+                                if (decoderCompEnabled) {
+                                    DrawSlider("Threshold", &decoderCompThresholdDb, -60.0f, 0.0f, "Level above which a voice gets compressed (dBFS)");
+                                    DrawSlider("Ratio", &decoderCompRatio, 1.0f, 20.0f, "How hard loud voices are pulled down (x:1)");
+                                }
+
+                                char streamText[48];
+                                snprintf(streamText, sizeof(streamText), "Incoming voices: %d", decoderContexts.size());
+                                ImGui::SetCursorPosX((decoderWindowWidth - ImGui::CalcTextSize(streamText).x) * 0.5f);
+                                ImGui::TextUnformatted(streamText);
+
+                                // One row per voice, numbered by its slot so the numbers stay put
+                                decoderContexts.forEach([&](int slot, DecoderContext* voice) {
+                                    ImGui::PushID(slot);
+                                    float voicePeak = voice->peak.load(std::memory_order_relaxed);
+                                    char voiceText[64];
+                                    snprintf(voiceText, sizeof(voiceText), "Voice %d  %s  %.0f dBFS", slot + 1,
+                                        voicePeak >= StreamMixer::SILENCE_LEVEL ? "talking" : "quiet",
+                                        20.0f * log10f(Max(voicePeak, 1e-5f)));
+                                    ImGui::SetCursorPosX(decoderLeftMargin);
+                                    ImGui::TextUnformatted(voiceText);
+
+                                    float voiceGain = voice->userGainDb.load(std::memory_order_relaxed);
+                                    float voicePan = voice->userPan.load(std::memory_order_relaxed);
+                                    DrawSlider("Voice Gain", &voiceGain, -24.0f, 12.0f, "Volume of this voice (dB)");
+                                    DrawSlider("Voice Pan", &voicePan, -1.0f, 1.0f, "Position of this voice, -1 left to 1 right");
+                                    voice->userGainDb.store(voiceGain, std::memory_order_relaxed);
+                                    voice->userPan.store(voicePan, std::memory_order_relaxed);
+                                    ImGui::PopID();
+                                });
+                            }
 
-                            // Add more decoder options here
+                            DrawAlignedSeparator("", rgbModeEnabled);
 
                             // End nested frame
                             EndNestedFrame(rgbModeEnabled);
@@ -3118,6 +4685,42 @@ namespace utilities {
                                 SetWindowDisplayAffinity(hwnd, Spoofing::Hider ? WDA_EXCLUDEFROMCAPTURE : WDA_NONE);
                             }
                             ImGui::PopStyleVar();
+
+                            DrawAlignedSeparator("Recording", rgbModeEnabled);
+
+                            // Capture the packets we send to an .opus file next to the config
+                            bool recording = packetRecorder.isRecording();
+                            static bool recordingFailed = false;
+                            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
+                            if (ImGui::Checkbox("Record Sent Audio", &recording)) {
+                                if (recording) {
+                                    char fileName[64];
+                                    time_t now = time(nullptr);
+                                    tm local = {};
+                                    localtime_s(&local, &now);
+                                    strftime(fileName, sizeof(fileName), "recording_%Y%m%d_%H%M%S.opus", &local);
+                                    recordingFailed = !packetRecorder.start(fileName);
+                                }
+                                else {
+                                    packetRecorder.stop();
+                                }
+                            }
+                            ImGui::PopStyleVar();
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::BeginTooltip();
+                                ImGui::TextUnformatted("Save exactly what is sent (after all effects and encoding) as an Ogg Opus file");
+                                ImGui::EndTooltip();
+                            }
+
+                            if (recordingFailed) {
+                                ImGui::Text("Could not create the recording file");
+                            }
+                            else if (!packetRecorder.getPath().empty()) {
+                                ImGui::Text("%s: %.1f s, %u packets, %u dropped, %u from other streams", packetRecorder.getPath().c_str(),
+                                    packetRecorder.getSeconds(), packetRecorder.getPacketsWritten(), packetRecorder.getPacketsDropped(),
+                                    packetRecorder.getPacketsIgnored());
+                            }
+
                             DrawAlignedSeparator("Color Settings", rgbModeEnabled);
 
                             ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(4, 3));
@@ -3243,6 +4846,69 @@ namespace utilities {
                             ImGui::Spacing();
                             ImGui::Spacing();
 
+                            // Performance Section
+                            DrawAlignedSeparator("Performance", rgbModeEnabled);
+
+                            ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.9f, 0.9f, 0.9f, 1.00f));
+                            ImGui::Text("Encoder ctl calls saved: %llu", ctlCallsSaved.load(std::memory_order_relaxed));
+
+                            // CPU budget controller of the stream shown in the meters
+                            if (adaptiveComplexityEnabled) {
+                                ImGui::Text("Frame load: %.0f%% (budget %.0f%%, effects %.0f us, encode %.0f us)",
+                                    meterDisplay.cpuLoad.load(std::memory_order_relaxed) * 100.0f, cpuBudgetPercent,
+                                    meterDisplay.effectsUs.load(std::memory_order_relaxed), meterDisplay.encodeUs.load(std::memory_order_relaxed));
+                                ImGui::Text("Complexity: %d%s", meterDisplay.complexity.load(std::memory_order_relaxed),
+                                    meterDisplay.effectsShed.load(std::memory_order_relaxed) ? ", reverb shed" : "");
+                                unsigned int decisionCount = meterDisplay.decisionCount.load(std::memory_order_relaxed);
+                                if (decisionCount > 0) {
+                                    ImGui::Text("Last decision: %s (%u so far)",
+                                        ComplexityController::DECISION_NAMES[meterDisplay.lastDecision.load(std::memory_order_relaxed)], decisionCount);
+                                }
+                            }
+
+                            // Offline benchmarks, run on a background thread
+                            static int selectedBenchmark = 0;
+                            float benchmarkComboWidth = 160.0f;
+                            ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 6.0f);
+                            ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(8, 6));
+                            ImGui::PushItemWidth(benchmarkComboWidth);
+                            if (ImGui::BeginCombo("##BenchmarkCombo", BenchmarkRunner::NAMES[selectedBenchmark])) {
+                                for (int i = 0; i < (int)BenchmarkId::Count; i++) {
+                                    const bool is_selected = (selectedBenchmark == i);
+                                    if (ImGui::Selectable(BenchmarkRunner::NAMES[i], is_selected)) {
+                                        selectedBenchmark = i;
+                                    }
+                                    if (is_selected)
+                                        ImGui::SetItemDefaultFocus();
+                                }
+                                ImGui::EndCombo();
+                            }
+                            ImGui::PopItemWidth();
+
+                            ImGui::SameLine();
+                            bool benchmarkRunning = benchmarkRunner.isRunning();
+                            if (ImGui::Button(benchmarkRunning ? "Running..." : "Run Benchmark", ImVec2(125, 0)) && !benchmarkRunning) {
+                                // The jitter buffer benchmark replays the last finished recording
+                                std::string replayPath = packetRecorder.isRecording() ? std::string() : packetRecorder.getPath();
+                                benchmarkRunner.start((BenchmarkId)selectedBenchmark, replayPath);
+                            }
+                            if (ImGui::IsItemHovered()) {
+                                ImGui::BeginTooltip();
+                                ImGui::TextUnformatted("Runs on its own encoder with synthetic audio (the jitter buffer replays the last recording), live calls are not affected");
+                                ImGui::EndTooltip();
+                            }
+                            ImGui::PopStyleVar(2);
+
+                            std::string benchmarkReport = benchmarkRunner.getReport();
+                            if (!benchmarkReport.empty()) {
+                                ImGui::TextUnformatted(benchmarkReport.c_str());
+                            }
+                            ImGui::PopStyleColor();
+
+                            // Spacer
+                            ImGui::Spacing();
+                            ImGui::Spacing();
+
                             // Version Information Section
                             DrawAlignedSeparator("Version Information", rgbModeEnabled);
 
@@ -1,7 +1,8 @@
 #include "imgui/imgui_impl_win32.h"
 #include "imgui/imgui_impl_dx9.h"
 #include "imgui/imgui.h"
-#include "../libraries/opus/include/opus.h"
+#include "libraries/opus/include/opus.h"
+#include "libraries/opus/include/opus_multistream.h"
 
 #include "d3d9.h"
 #include "tchar.h"
@@ -16,9 +17,9 @@ static D3DPRESENT_PARAMETERS    g_d3dpp = {};
 extern HWND hwnd;
 extern bool show_imgui_window;
 
-// Reverb effect class forward declaration
-class FreeverbReverb;
-extern FreeverbReverb reverbProcessor;
+// Per-encoder DSP state and the settings the effect chain reads, defined in overlay.cpp
+struct EncoderContext;
+struct EffectSettings;
 
 bool CreateDeviceD3D(HWND hWnd);
 void CleanupDeviceD3D();
@@ -34,9 +35,21 @@ const char* GetKeyName(int key);
 void ChangeHotkey(int newKey);
 
 // Audio processing functions
-void ApplyAudioEffects(float* audioBuffer, int bufferSize, int channels);
+void ApplyAudioEffects(EncoderContext& ctx, const EffectSettings& fx, float* audioBuffer, int bufferSize, int channels);
 extern "C" opus_int32 custom_opus_encode(OpusEncoder *st, const opus_int16 *pcm, int frame_size,
                                    unsigned char *data, opus_int32 max_data_bytes);
+extern "C" opus_int32 custom_opus_encode_float(OpusEncoder *st, const float *pcm, int frame_size,
+                                   unsigned char *data, opus_int32 max_data_bytes);
+extern "C" int custom_opus_multistream_encode(OpusMSEncoder *st, const opus_int16 *pcm, int frame_size,
+                                   unsigned char *data, opus_int32 max_data_bytes);
+extern "C" int custom_opus_multistream_encode_float(OpusMSEncoder *st, const float *pcm, int frame_size,
+                                   unsigned char *data, opus_int32 max_data_bytes);
+extern "C" void custom_opus_encoder_destroy(OpusEncoder *st);
+extern void (*original_opus_encoder_destroy)(OpusEncoder *st);
+extern "C" int custom_opus_decode(OpusDecoder *st, const unsigned char *data, opus_int32 len, opus_int16 *pcm,
+                                   int frame_size, int decode_fec);
+extern int (*original_opus_decode)(OpusDecoder *st, const unsigned char *data, opus_int32 len, opus_int16 *pcm,
+                                   int frame_size, int decode_fec);
 
 namespace utilities::ui {
 	void start();
@@ -0,0 +1,389 @@
+#include "packetRecorder.hpp"
+#include "libraries/opus/include/opus.h"
+#include <algorithm> // For std::reverse
+#include <chrono>
+#include <cstring>   // For memcpy, memcmp, strlen
+#include <iterator>
+#include <vector>
+
+namespace {
+    constexpr int WRITER_POLL_MS = 20;
+
+    long long NowMs() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Ogg's CRC-32: polynomial 0x04C11DB7, MSB first, no reflection, zero init
+    struct OggCrcTable {
+        unsigned int values[256];
+        OggCrcTable() {
+            for (unsigned int i = 0; i < 256; i++) {
+                unsigned int r = i << 24;
+                for (int bit = 0; bit < 8; bit++) {
+                    r = (r & 0x80000000u) ? (r << 1) ^ 0x04C11DB7u : r << 1;
+                }
+                values[i] = r;
+            }
+        }
+    };
+
+    unsigned int OggCrc(const unsigned char* data, size_t length, unsigned int crc = 0) {
+        static const OggCrcTable table;
+        for (size_t i = 0; i < length; i++) {
+            crc = (crc << 8) ^ table.values[((crc >> 24) ^ data[i]) & 0xFF];
+        }
+        return crc;
+    }
+
+    void PutLE16(std::vector<unsigned char>& out, unsigned int value) {
+        out.push_back(value & 0xFF);
+        out.push_back((value >> 8) & 0xFF);
+    }
+
+    void PutLE32(std::vector<unsigned char>& out, unsigned int value) {
+        PutLE16(out, value & 0xFFFF);
+        PutLE16(out, value >> 16);
+    }
+
+    // One logical Ogg stream, packets are collected into a page until it's full
+    class OggStreamWriter {
+    public:
+        explicit OggStreamWriter(unsigned int serial) : serial(serial) {}
+
+        // Add a packet ending at granule, starting a new page first if it wouldn't fit
+        void addPacket(std::ofstream& file, const unsigned char* data, int length, long long granule) {
+            int segments = length / 255 + 1;
+            bool pageFull = lacing.size() + segments > 255 || granule - pageStartGranule > PacketRecorder::PAGE_MAX_SAMPLES;
+            if (!lacing.empty() && pageFull) {
+                flush(file, false);
+            }
+            if (lacing.empty()) {
+                pageStartGranule = pageGranule;
+            }
+
+            for (int i = 0; i < segments - 1; i++) {
+                lacing.push_back(255);
+            }
+            lacing.push_back((unsigned char)(length % 255));
+            body.insert(body.end(), data, data + length);
+            pageGranule = granule;
+        }
+
+        // Write the collected packets as one page
+        void flush(std::ofstream& file, bool endOfStream) {
+            if (lacing.empty()) return;
+
+            std::vector<unsigned char> page = { 'O', 'g', 'g', 'S', 0 };
+            unsigned char flags = 0;
+            if (sequence == 0) flags |= 0x02;   // Beginning of stream
+            if (endOfStream) flags |= 0x04;
+            page.push_back(flags);
+            PutLE32(page, (unsigned int)(pageGranule & 0xFFFFFFFF));
+            PutLE32(page, (unsigned int)(pageGranule >> 32));
+            PutLE32(page, serial);
+            PutLE32(page, sequence++);
+            PutLE32(page, 0);                   // CRC, filled in below
+            page.push_back((unsigned char)lacing.size());
+            page.insert(page.end(), lacing.begin(), lacing.end());
+            page.insert(page.end(), body.begin(), body.end());
+
+            unsigned int crc = OggCrc(page.data(), page.size());
+            page[22] = crc & 0xFF;
+            page[23] = (crc >> 8) & 0xFF;
+            page[24] = (crc >> 16) & 0xFF;
+            page[25] = (crc >> 24) & 0xFF;
+
+            file.write(reinterpret_cast<const char*>(page.data()), page.size());
+            file.flush();
+            lacing.clear();
+            body.clear();
+        }
+
+    private:
+        unsigned int serial;
+        unsigned int sequence = 0;
+        long long pageGranule = 0;
+        long long pageStartGranule = 0;
+        std::vector<unsigned char> lacing;
+        std::vector<unsigned char> body;
+    };
+
+    // Identification and comment headers, each on a page of its own (RFC 7845)
+    void WriteOpusHeaders(std::ofstream& file, OggStreamWriter& ogg, int channels, int inputSampleRate, int preSkip) {
+        std::vector<unsigned char> head = { 'O', 'p', 'u', 's', 'H', 'e', 'a', 'd', 1 };
+        head.push_back((unsigned char)channels);
+        PutLE16(head, (unsigned int)preSkip);
+        PutLE32(head, (unsigned int)inputSampleRate);
+        PutLE16(head, 0);   // Output gain
+        head.push_back(0);  // Channel mapping family 0: mono or stereo
+        ogg.addPacket(file, head.data(), (int)head.size(), 0);
+        ogg.flush(file, false);
+
+        const char* vendor = opus_get_version_string();
+        unsigned int vendorLength = (unsigned int)strlen(vendor);
+        std::vector<unsigned char> tags = { 'O', 'p', 'u', 's', 'T', 'a', 'g', 's' };
+        PutLE32(tags, vendorLength);
+        tags.insert(tags.end(), vendor, vendor + vendorLength);
+        PutLE32(tags, 0);   // No user comments
+        ogg.addPacket(file, tags.data(), (int)tags.size(), 0);
+        ogg.flush(file, false);
+    }
+}
+
+PacketRecorder::~PacketRecorder() {
+    stop();
+}
+
+bool PacketRecorder::start(const std::string& newPath) {
+    stop();
+
+    file.open(newPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    path = newPath;
+    packetsWritten.store(0, std::memory_order_relaxed);
+    packetsDropped.store(0, std::memory_order_relaxed);
+    packetsIgnored.store(0, std::memory_order_relaxed);
+    seconds.store(0.0f, std::memory_order_relaxed);
+
+    // Anything left in the ring belongs to the previous file, the writer skips it by session
+    recordedStream.store(nullptr, std::memory_order_relaxed);
+    unsigned int newSession = session.fetch_add(1, std::memory_order_acq_rel) + 1;
+    droppedSamples.store((unsigned long long)newSession << 32, std::memory_order_relaxed);
+    recording.store(true, std::memory_order_seq_cst);
+
+    writer = std::thread(&PacketRecorder::writerLoop, this, newSession);
+    return true;
+}
+
+void PacketRecorder::stop() {
+    recording.store(false, std::memory_order_seq_cst);
+
+    // A push that saw recording still on finishes before the ring changes hands
+    while (pushesInFlight.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+    if (writer.joinable()) {
+        writer.join();
+    }
+    if (file.is_open()) {
+        file.close();
+    }
+}
+
+void PacketRecorder::push(const void* stream, const unsigned char* packet, int length, int channels, int inputSampleRate, int preSkip) {
+    if (length <= 0) return;
+
+    // Announce the push before checking recording, stop() waits for it either way
+    pushesInFlight.fetch_add(1, std::memory_order_seq_cst);
+    if (recording.load(std::memory_order_seq_cst)) {
+        pushPacket(stream, packet, length, channels, inputSampleRate, preSkip);
+    }
+    pushesInFlight.fetch_sub(1, std::memory_order_release);
+}
+
+void PacketRecorder::release(const void* stream) {
+    recordedStream.compare_exchange_strong(stream, nullptr, std::memory_order_relaxed);
+}
+
+void PacketRecorder::pushPacket(const void* stream, const unsigned char* packet, int length, int channels, int inputSampleRate, int preSkip) {
+    int samples = opus_packet_get_nb_samples(packet, length, 48000);
+    if (samples <= 0) return;
+
+    // One thread fills the ring at a time, a push that finds another at it loses its packet
+    if (producing.exchange(true, std::memory_order_acquire)) {
+        if (recordedStream.load(std::memory_order_relaxed) == stream) {
+            countDropped(samples);
+        }
+        else {
+            packetsIgnored.fetch_add(1, std::memory_order_relaxed);
+        }
+        return;
+    }
+    if (!claim(stream, NowMs())) {
+        packetsIgnored.fetch_add(1, std::memory_order_relaxed);
+        producing.store(false, std::memory_order_release);
+        return;
+    }
+
+    unsigned int head = writeIndex.load(std::memory_order_relaxed);
+    if (length > MAX_PACKET_BYTES || head - readIndex.load(std::memory_order_acquire) >= RING_SLOTS) {
+        countDropped(samples);
+        producing.store(false, std::memory_order_release);
+        return;
+    }
+
+    unsigned int currentSession = session.load(std::memory_order_acquire);
+    unsigned long long sessionTag = (unsigned long long)currentSession << 32;
+    unsigned long long gap = droppedSamples.exchange(sessionTag, std::memory_order_relaxed);
+
+    Slot& slot = slots[head % RING_SLOTS];
+    slot.session = currentSession;
+    slot.stream = stream;
+    slot.samples = samples;
+    slot.gapSamples = (gap & ~0xFFFFFFFFull) == sessionTag ? (int)(gap & 0xFFFFFFFFull) : 0;
+    slot.length = length;
+    slot.channels = channels;
+    slot.inputSampleRate = inputSampleRate;
+    slot.preSkip = preSkip;
+    memcpy(slot.data, packet, length);
+    writeIndex.store(head + 1, std::memory_order_release);
+    producing.store(false, std::memory_order_release);
+}
+
+// True when stream owns the recording, taking it over from an owner that was released
+// or went quiet. Called with producing held.
+bool PacketRecorder::claim(const void* stream, long long now) {
+    const void* owner = recordedStream.load(std::memory_order_relaxed);
+    if (owner != stream) {
+        if (owner && now - ownerLastPushMs.load(std::memory_order_relaxed) <= OWNER_IDLE_MS) return false;
+        recordedStream.store(stream, std::memory_order_relaxed);
+
+        // Gaps left by the previous owner end with its logical stream
+        droppedSamples.store((unsigned long long)session.load(std::memory_order_acquire) << 32, std::memory_order_relaxed);
+    }
+    ownerLastPushMs.store(now, std::memory_order_relaxed);
+    return true;
+}
+
+// Time keeps running over dropped packets, so the file shows the gap
+void PacketRecorder::countDropped(int samples) {
+    unsigned long long sessionTag = (unsigned long long)session.load(std::memory_order_acquire) << 32;
+    unsigned long long dropped = droppedSamples.load(std::memory_order_relaxed);
+    unsigned long long updated;
+    do {
+        updated = (dropped & ~0xFFFFFFFFull) == sessionTag ? dropped + (unsigned int)samples : sessionTag | (unsigned int)samples;
+    } while (!droppedSamples.compare_exchange_weak(dropped, updated, std::memory_order_relaxed));
+    packetsDropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PacketRecorder::writerLoop(unsigned int writerSession) {
+    unsigned int serial = (unsigned int)std::chrono::steady_clock::now().time_since_epoch().count();
+    OggStreamWriter ogg(serial);
+    const void* writtenStream = nullptr;
+    long long granule = 0;
+    long long chainedSamples = 0;   // Length of the logical streams already finished
+
+    while (true) {
+        // Checked before draining, so every packet queued before stop() makes it in
+        bool stopping = !recording.load(std::memory_order_acquire);
+
+        unsigned int tail = readIndex.load(std::memory_order_relaxed);
+        unsigned int head = writeIndex.load(std::memory_order_acquire);
+        while (tail != head) {
+            const Slot& slot = slots[tail % RING_SLOTS];
+            if (slot.session == writerSession) {
+                if (slot.stream != writtenStream) {
+                    // Another encoder took over: end the current logical stream and chain a new one
+                    if (writtenStream) {
+                        ogg.flush(file, true);
+                        ogg = OggStreamWriter(++serial);
+                        chainedSamples += granule;
+                        granule = 0;
+                    }
+                    WriteOpusHeaders(file, ogg, slot.channels, slot.inputSampleRate, slot.preSkip);
+                    writtenStream = slot.stream;
+                }
+                granule += (long long)slot.gapSamples + slot.samples;
+                ogg.addPacket(file, slot.data, slot.length, granule);
+                packetsWritten.fetch_add(1, std::memory_order_relaxed);
+                seconds.store((float)((chainedSamples + granule) / 48000.0), std::memory_order_relaxed);
+            }
+
+            tail++;
+            readIndex.store(tail, std::memory_order_release);
+        }
+
+        if (stopping) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(WRITER_POLL_MS));
+    }
+
+    ogg.flush(file, true);
+}
+
+bool ReadOggOpusFile(const std::string& path, std::vector<ReplayPacket>& packets, int& channels) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        return false;
+    }
+    std::vector<unsigned char> file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    packets.clear();
+    channels = 0;
+    int headerPackets = 0;
+    long long chainStart = 0;                       // Where the current logical stream starts
+    long long chainEnd = 0;                         // End of its last audio page
+    std::vector<unsigned char> partial;             // Packet continued across pages
+    std::vector<std::vector<unsigned char>> ended;  // Packets that end on the current page
+
+    size_t pos = 0;
+    while (pos + 27 <= file.size()) {
+        const unsigned char* page = file.data() + pos;
+        if (memcmp(page, "OggS", 4) != 0) {
+            return false;
+        }
+        int segments = page[26];
+        size_t headerSize = 27 + (size_t)segments;
+        if (pos + headerSize > file.size()) break;
+
+        unsigned long long granule = 0;
+        for (int b = 7; b >= 0; b--) {
+            granule = (granule << 8) | page[6 + b];
+        }
+
+        size_t bodySize = 0;
+        for (int i = 0; i < segments; i++) {
+            bodySize += page[27 + i];
+        }
+        if (pos + headerSize + bodySize > file.size()) break;
+
+        // A chained logical stream brings its own headers and restarts its granule at zero
+        if ((page[5] & 0x02) && headerPackets == 2) {
+            headerPackets = 0;
+            partial.clear();
+            chainStart = chainEnd;
+        }
+
+        const unsigned char* body = page + headerSize;
+        ended.clear();
+        for (int i = 0; i < segments; i++) {
+            int lace = page[27 + i];
+            partial.insert(partial.end(), body, body + lace);
+            body += lace;
+            if (lace < 255) {
+                ended.push_back(partial);
+                partial.clear();
+            }
+        }
+        pos += headerSize + bodySize;
+
+        // OpusHead, then OpusTags, then audio
+        size_t first = 0;
+        while (headerPackets < 2 && first < ended.size()) {
+            const std::vector<unsigned char>& header = ended[first++];
+            if (headerPackets == 0) {
+                if (header.size() < 19 || memcmp(header.data(), "OpusHead", 8) != 0) {
+                    return false;
+                }
+                if (channels == 0) channels = header[9];
+            }
+            headerPackets++;
+        }
+        if (first == ended.size() || granule == ~0ULL) continue;
+
+        // The page's granule is the end of its last packet, walk back from there
+        size_t pageStart = packets.size();
+        long long end = chainStart + (long long)granule;
+        chainEnd = end;
+        for (size_t i = ended.size(); i-- > first;) {
+            const std::vector<unsigned char>& data = ended[i];
+            int samples = opus_packet_get_nb_samples(data.data(), (opus_int32)data.size(), 48000);
+            if (samples <= 0) continue;
+            end -= samples;
+            packets.push_back({ end, data });
+        }
+        std::reverse(packets.begin() + pageStart, packets.end());
+    }
+    return channels > 0 && !packets.empty();
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// PacketRecorder - captures the encoded packets we send into an Ogg Opus file.
+//
+// The encode hook copies each packet and its granule position (end of the packet
+// in 48 kHz samples) into a fixed single-producer/single-consumer ring; a writer
+// thread muxes them into Ogg pages and is the only one touching the file. When the
+// ring is full the packet is dropped and counted, the audio thread never waits.
+// Memory stays at RING_SLOTS * MAX_PACKET_BYTES no matter how long it records.
+//
+// One stream is recorded at a time: the first encoder that sends a packet after
+// start() claims the recorder. Once that encoder is destroyed (release()) or has sent
+// nothing for OWNER_IDLE_MS, the next stream to send takes over and the writer chains
+// a new logical Ogg stream with its own headers, so a recreated encoder keeps the
+// recording going. Packets from other streams while the owner is live are counted as
+// ignored.
+//
+// Every recording is a session. Each slot carries the session it was queued in
+// and the writer drops slots from older ones, and stop() waits for pushes already
+// in flight, so a packet from the previous recording can never open the next file.
+// Timing travels through the ring as well: a slot holds its own duration plus the
+// duration of the packets dropped just before it, and the writer adds them up
+// into granule positions, so no producer-side state outlives a session.
+class PacketRecorder {
+public:
+    static constexpr int RING_SLOTS = 256;          // About 5 s of 20 ms packets
+    static constexpr int MAX_PACKET_BYTES = 4000;   // Larger than any packet we send in practice
+    static constexpr int PAGE_MAX_SAMPLES = 48000;  // Ogg Opus pages span at most a second
+    static constexpr int OWNER_IDLE_MS = 1000;      // Quiet time before another stream takes over
+
+    PacketRecorder() = default;
+    ~PacketRecorder();
+    PacketRecorder(const PacketRecorder&) = delete;
+    PacketRecorder& operator=(const PacketRecorder&) = delete;
+
+    // Start recording into path, false if the file can't be created (UI thread)
+    bool start(const std::string& path);
+
+    // Stop and finish the file, waits for the writer (UI thread)
+    void stop();
+
+    bool isRecording() const { return recording.load(std::memory_order_acquire); }
+
+    // Queue one packet sent by stream (audio thread). channels, inputSampleRate and
+    // preSkip (48 kHz samples) describe the encoder for the file header.
+    void push(const void* stream, const unsigned char* packet, int length, int channels, int inputSampleRate, int preSkip);
+
+    // stream's encoder is gone, the next stream to send takes the recording over
+    void release(const void* stream);
+
+    // Recording stats for the UI
+    std::string getPath() const { return path; }
+    unsigned int getPacketsWritten() const { return packetsWritten.load(std::memory_order_relaxed); }
+    unsigned int getPacketsDropped() const { return packetsDropped.load(std::memory_order_relaxed); }
+    unsigned int getPacketsIgnored() const { return packetsIgnored.load(std::memory_order_relaxed); }
+    float getSeconds() const { return seconds.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        unsigned int session;
+        const void* stream;     // A new stream starts a new logical Ogg stream
+        int samples;            // Duration in 48 kHz samples
+        int gapSamples;         // Packets dropped right before this one
+        int length;
+        int channels;
+        int inputSampleRate;
+        int preSkip;
+        unsigned char data[MAX_PACKET_BYTES];
+    };
+
+    Slot slots[RING_SLOTS];
+    std::atomic<unsigned int> writeIndex{ 0 };
+    std::atomic<unsigned int> readIndex{ 0 };
+
+    std::atomic<bool> recording{ false };
+    std::atomic<const void*> recordedStream{ nullptr };
+    std::atomic<long long> ownerLastPushMs{ 0 };
+    std::atomic<bool> producing{ false };      // Held by the thread filling the ring
+    std::atomic<unsigned int> session{ 0 };
+    std::atomic<int> pushesInFlight{ 0 };
+
+    // Dropped samples not yet handed to a slot: session in the high 32 bits, samples in the low
+    std::atomic<unsigned long long> droppedSamples{ 0 };
+
+    std::atomic<unsigned int> packetsWritten{ 0 };
+    std::atomic<unsigned int> packetsDropped{ 0 };
+    std::atomic<unsigned int> packetsIgnored{ 0 };
+    std::atomic<float> seconds{ 0.0f };
+
+    std::string path;
+    std::ofstream file;
+    std::thread writer;
+
+    void pushPacket(const void* stream, const unsigned char* packet, int length, int channels, int inputSampleRate, int preSkip);
+    bool claim(const void* stream, long long now);
+    void countDropped(int samples);
+    void writerLoop(unsigned int writerSession);
+};
+
+// One packet read back from a recording
+struct ReplayPacket {
+    long long timestamp;    // Start of the packet in 48 kHz samples
+    std::vector<unsigned char> data;
+};
+
+// Read the audio packets of an Ogg Opus file, like the ones PacketRecorder writes.
+// Timestamps are worked back from each page's granule position, so gaps left by
+// dropped packets stay in; chained logical streams play one after the other and
+// channels comes from the first. False if the file can't be read or isn't Ogg Opus.
+bool ReadOggOpusFile(const std::string& path, std::vector<ReplayPacket>& packets, int& channels);
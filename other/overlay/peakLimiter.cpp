@@ -0,0 +1,145 @@
+#include "peakLimiter.hpp"
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For expf, fabsf
+#include <cstring>   // For memset
+
+void PeakLimiter::configure(int rate, int numChannels, float lookaheadTime, float releaseTime) {
+    rate = std::max(8000, std::min(rate, MAX_SAMPLE_RATE));
+    numChannels = std::max(1, std::min(numChannels, MAX_CHANNELS));
+    lookaheadTime = std::max(MIN_LOOKAHEAD_MS, std::min(lookaheadTime, MAX_LOOKAHEAD_MS));
+
+    if (rate == sampleRate && numChannels == channels &&
+        lookaheadTime == lookaheadMs && releaseTime == releaseMs) {
+        return;
+    }
+
+    sampleRate = rate;
+    channels = numChannels;
+    lookaheadMs = lookaheadTime;
+    releaseMs = releaseTime;
+
+    lookahead = std::max(1, std::min((int)(sampleRate * lookaheadMs / 1000.0f), MAX_LOOKAHEAD));
+
+    // One-pole release towards unity gain
+    releaseCoeff = 1.0f - expf(-1.0f / (std::max(1.0f, releaseMs) * 0.001f * sampleRate));
+
+    reset();
+}
+
+void PeakLimiter::setCeiling(float linear) {
+    ceiling = std::max(0.01f, std::min(linear, 1.0f));
+}
+
+void PeakLimiter::setSidechainLatency(int frames) {
+    frames = std::max(0, std::min(frames, MAX_SIDECHAIN_LATENCY));
+    if (frames == sidechainLatency) return;
+    sidechainLatency = frames;
+    reset();
+}
+
+void PeakLimiter::reset() {
+    memset(delayLine, 0, sizeof(delayLine));
+    delayPos = 0;
+    memset(alignLine, 0, sizeof(alignLine));
+    alignPos = 0;
+
+    windowFront = 0;
+    windowCount = 0;
+
+    // The box filter starts full of unity gain
+    for (int i = 0; i < MAX_LOOKAHEAD; i++) {
+        boxHistory[i] = 1.0f;
+    }
+    boxPos = 0;
+    boxSum = (double)lookahead;
+
+    frameCounter = 0;
+    envelope = 1.0f;
+    currentGain = 1.0f;
+}
+
+float PeakLimiter::slidingMinimum(float requiredGain) {
+    // Drop entries from the back that can never be the minimum again
+    while (windowCount > 0) {
+        int back = windowFront + windowCount - 1;
+        if (back >= WINDOW_CAPACITY) back -= WINDOW_CAPACITY;
+        if (window[back].gain < requiredGain) break;
+        windowCount--;
+    }
+
+    int slot = windowFront + windowCount;
+    if (slot >= WINDOW_CAPACITY) slot -= WINDOW_CAPACITY;
+    window[slot].frame = frameCounter;
+    window[slot].gain = requiredGain;
+    windowCount++;
+
+    // Drop the front once it has slid out of the window
+    if (frameCounter - window[windowFront].frame > (unsigned int)lookahead) {
+        if (++windowFront >= WINDOW_CAPACITY) windowFront = 0;
+        windowCount--;
+    }
+
+    return window[windowFront].gain;
+}
+
+void PeakLimiter::process(float* buffer, int frames, const float* sidechain) {
+    if (!buffer || frames <= 0 || channels <= 0) return;
+
+    const float boxScale = 1.0f / lookahead;
+
+    for (int i = 0; i < frames; i++) {
+        float* frame = buffer + i * channels;
+        float* delayed = delayLine + delayPos * channels;
+
+        // The frame whose sidechain level arrives now
+        float input[MAX_CHANNELS];
+        if (sidechainLatency > 0) {
+            float* aligned = alignLine + alignPos * channels;
+            for (int ch = 0; ch < channels; ch++) {
+                input[ch] = aligned[ch];
+                aligned[ch] = frame[ch];
+            }
+            if (++alignPos >= sidechainLatency) alignPos = 0;
+        }
+        else {
+            for (int ch = 0; ch < channels; ch++) {
+                input[ch] = frame[ch];
+            }
+        }
+
+        // Linked peak across channels
+        float peak = 0.0f;
+        for (int ch = 0; ch < channels; ch++) {
+            peak = std::max(peak, fabsf(input[ch]));
+        }
+        if (sidechain) {
+            peak = std::max(peak, sidechain[i]);
+        }
+
+        // Gain needed for this frame to sit exactly at the ceiling
+        float requiredGain = ceiling / std::max(peak, ceiling);
+
+        // Attack is instant on the window minimum, release is smooth
+        float minimum = slidingMinimum(requiredGain);
+        envelope = minimum < envelope ? minimum : envelope + releaseCoeff * (minimum - envelope);
+
+        // Box filter spreads the attack over the look-ahead without overshooting
+        boxSum += envelope - boxHistory[boxPos];
+        boxHistory[boxPos] = envelope;
+        if (++boxPos >= lookahead) boxPos = 0;
+        float gain = (float)boxSum * boxScale;
+        currentGain = gain;
+
+        // Swap the new frame into the delay line and output the one leaving it
+        for (int ch = 0; ch < channels; ch++) {
+            float out = delayed[ch] * gain;
+            delayed[ch] = input[ch];
+
+            // Rounding guard, the gain already keeps us under the ceiling
+            frame[ch] = std::max(-ceiling, std::min(out, ceiling));
+        }
+
+        if (++delayPos >= lookahead) delayPos = 0;
+        frameCounter++;
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+// PeakLimiter - look-ahead brickwall limiter for interleaved float audio.
+//
+// Every frame's required gain (ceiling / peak, linked across channels) goes through
+// a sliding-window minimum kept in a monotonic deque, then a release follower and a
+// box filter as long as the look-ahead. The audio is delayed by the same amount, so
+// the smoothed gain is already down when a peak leaves the delay line. A sidechain
+// that reports its levels late (a true-peak detector's interpolator) is lined up by
+// delaying the audio and its sample peaks by the same amount before all of that.
+// Everything is O(1) per frame and the state is fixed size - nothing allocates at runtime.
+class PeakLimiter {
+public:
+    static constexpr int MAX_CHANNELS = 2;
+    static constexpr int MAX_SAMPLE_RATE = 48000;
+    static constexpr float MIN_LOOKAHEAD_MS = 1.0f;
+    static constexpr float MAX_LOOKAHEAD_MS = 5.0f;
+    static constexpr float DEFAULT_RELEASE_MS = 60.0f;
+    static constexpr float DEFAULT_CEILING = 0.95f;
+    static constexpr int MAX_SIDECHAIN_LATENCY = 16;
+
+    // Longest look-ahead in frames, at the highest sample rate
+    static constexpr int MAX_LOOKAHEAD = (int)(MAX_SAMPLE_RATE * MAX_LOOKAHEAD_MS / 1000.0f) + 1;
+
+    PeakLimiter() = default;
+
+    // Set format and timing. Clears the state if anything changed.
+    void configure(int sampleRate, int numChannels, float lookaheadMs, float releaseMs = DEFAULT_RELEASE_MS);
+
+    // Output ceiling as a linear amplitude
+    void setCeiling(float linear);
+
+    // How many frames late the sidechain levels passed to process() are, e.g.
+    // TruePeakDetector::LATENCY. Clears the state if it changed.
+    void setSidechainLatency(int frames);
+
+    // Clear delay line and gain state
+    void reset();
+
+    // Limit a block in place. frames = samples per channel.
+    // sidechain (optional, one value per frame) adds a detection level, e.g. a
+    // true-peak estimate, on top of the sample peaks.
+    void process(float* buffer, int frames, const float* sidechain = nullptr);
+
+    // Gain applied to the most recent output frame (1.0 = no reduction)
+    float getCurrentGain() const { return currentGain; }
+
+    // Delay added by the look-ahead and the sidechain alignment, in frames
+    int getLatency() const { return lookahead + sidechainLatency; }
+
+private:
+    // One entry of the sliding-minimum deque
+    struct WindowEntry {
+        unsigned int frame;
+        float gain;
+    };
+
+    float delayLine[MAX_LOOKAHEAD * MAX_CHANNELS] = {};
+    int delayPos = 0;
+
+    // Holds the input back until the sidechain's level for it arrives
+    float alignLine[MAX_SIDECHAIN_LATENCY * MAX_CHANNELS] = {};
+    int alignPos = 0;
+    int sidechainLatency = 0;
+
+    // Monotonic deque (ring buffer): gains increase from front to back.
+    // Holds the window plus the frame being pushed before the front is evicted.
+    static constexpr int WINDOW_CAPACITY = MAX_LOOKAHEAD + 2;
+    WindowEntry window[WINDOW_CAPACITY] = {};
+    int windowFront = 0;
+    int windowCount = 0;
+
+    // Box filter over the released gain
+    float boxHistory[MAX_LOOKAHEAD] = {};
+    int boxPos = 0;
+    double boxSum = 0.0;
+
+    unsigned int frameCounter = 0;
+    float envelope = 1.0f;
+    float currentGain = 1.0f;
+    float releaseCoeff = 0.0f;
+    float ceiling = DEFAULT_CEILING;
+
+    int sampleRate = 0;
+    int channels = 0;
+    int lookahead = 1;
+    float lookaheadMs = 0.0f;
+    float releaseMs = 0.0f;
+
+    // Smallest required gain over the last lookahead + 1 frames
+    float slidingMinimum(float requiredGain);
+};
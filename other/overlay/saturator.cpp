@@ -0,0 +1,173 @@
+#include "saturator.hpp"
+#include <emmintrin.h>
+#include <algorithm> // For std::min, std::max
+
+const char* const Saturator::NAMES[(int)SaturatorType::Count] = {
+    "Cubic", "Tanh", "Arctan", "Hard Clip (ADAA)"
+};
+
+namespace {
+    const float HALF_PI = 1.57079632679f;
+    const float TWO_OVER_PI = 0.63661977236f;
+
+    inline __m128 Abs(__m128 x) {
+        return _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+    }
+
+    inline __m128 Clamp(__m128 x, __m128 limit) {
+        return _mm_max_ps(_mm_sub_ps(_mm_setzero_ps(), limit), _mm_min_ps(x, limit));
+    }
+
+    // mask ? a : b
+    inline __m128 Select(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    // All curves below take x normalized to the ceiling and return values in [-1, 1]
+
+    // 1.5u - 0.5u^3 with u = x / 1.5: unity slope at zero, exact 1.0 at |x| = 1.5
+    inline __m128 CubicCurve(__m128 x) {
+        x = Clamp(x, _mm_set1_ps(1.5f));
+        __m128 x3 = _mm_mul_ps(_mm_mul_ps(x, x), x);
+        return _mm_sub_ps(x, _mm_mul_ps(_mm_set1_ps(4.0f / 27.0f), x3));
+    }
+
+    // tanh(x) ~ x (27 + x^2) / (27 + 9 x^2), exact 1.0 at |x| = 3
+    inline __m128 TanhCurve(__m128 x) {
+        x = Clamp(x, _mm_set1_ps(3.0f));
+        __m128 x2 = _mm_mul_ps(x, x);
+        __m128 num = _mm_mul_ps(x, _mm_add_ps(_mm_set1_ps(27.0f), x2));
+        __m128 den = _mm_add_ps(_mm_set1_ps(27.0f), _mm_mul_ps(_mm_set1_ps(9.0f), x2));
+        return _mm_div_ps(num, den);
+    }
+
+    // (2/pi) atan(pi/2 x): unity slope at zero, approaches 1 slowly
+    inline __m128 ArctanCurve(__m128 x) {
+        x = _mm_mul_ps(x, _mm_set1_ps(HALF_PI));
+
+        // atan(t) ~ pi/4 t - t (|t| - 1)(0.2447 + 0.0663 |t|) on |t| <= 1,
+        // atan(x) = sign(x) pi/2 - atan(1/x) outside
+        __m128 ax = Abs(x);
+        __m128 big = _mm_cmpgt_ps(ax, _mm_set1_ps(1.0f));
+        __m128 signBit = _mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32((int)0x80000000)));
+        __m128 safe = Select(big, x, _mm_set1_ps(1.0f));
+        __m128 t = Select(big, _mm_div_ps(_mm_set1_ps(1.0f), safe), x);
+        __m128 at = Abs(t);
+        __m128 poly = _mm_add_ps(_mm_set1_ps(0.2447f), _mm_mul_ps(_mm_set1_ps(0.0663f), at));
+        __m128 atanT = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(0.785398163f), t),
+                                  _mm_mul_ps(_mm_mul_ps(t, _mm_sub_ps(at, _mm_set1_ps(1.0f))), poly));
+        __m128 outer = _mm_sub_ps(_mm_or_ps(_mm_set1_ps(HALF_PI), signBit), atanT);
+        return _mm_mul_ps(Select(big, outer, atanT), _mm_set1_ps(TWO_OVER_PI));
+    }
+
+    // Antiderivative of the unit hard clip: x^2/2 inside, |x| - 1/2 outside
+    inline __m128 ClipAntiderivative(__m128 x) {
+        __m128 ax = Abs(x);
+        __m128 inside = _mm_min_ps(ax, _mm_set1_ps(1.0f));
+        return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.5f), _mm_mul_ps(inside, inside)), _mm_sub_ps(ax, inside));
+    }
+
+    // First order ADAA: (F(x) - F(prev)) / (x - prev), midpoint clip when the two are too close
+    inline __m128 HardClipAdaa(__m128 x, __m128 prev) {
+        __m128 one = _mm_set1_ps(1.0f);
+        __m128 diff = _mm_sub_ps(x, prev);
+        __m128 useAdaa = _mm_cmpgt_ps(Abs(diff), _mm_set1_ps(1e-4f));
+        __m128 safeDiff = Select(useAdaa, diff, one);
+        __m128 adaa = _mm_div_ps(_mm_sub_ps(ClipAntiderivative(x), ClipAntiderivative(prev)), safeDiff);
+        __m128 mid = Clamp(_mm_mul_ps(_mm_add_ps(x, prev), _mm_set1_ps(0.5f)), one);
+        return Clamp(Select(useAdaa, adaa, mid), one);
+    }
+
+    inline __m128 ApplyCurve(SaturatorType type, __m128 x) {
+        switch (type) {
+        case SaturatorType::Cubic:  return CubicCurve(x);
+        case SaturatorType::Arctan: return ArctanCurve(x);
+        default:                    return TanhCurve(x);
+        }
+    }
+}
+
+void Saturator::configure(SaturatorType newType, int numChannels) {
+    numChannels = std::max(1, std::min(numChannels, MAX_CHANNELS));
+    if (newType == type && numChannels == channels) return;
+
+    type = newType;
+    channels = numChannels;
+    reset();
+}
+
+void Saturator::reset() {
+    for (int ch = 0; ch < MAX_CHANNELS; ch++) {
+        prevInput[ch] = 0.0f;
+    }
+}
+
+void Saturator::process(float* buffer, int count, float ceiling) {
+    if (!buffer || count <= 0 || ceiling <= 0.0f) return;
+
+    const __m128 scale = _mm_set1_ps(1.0f / ceiling);
+    const __m128 unscale = _mm_set1_ps(ceiling);
+    const int vectorCount = count & ~3;
+
+    if (type != SaturatorType::HardClip) {
+        for (int i = 0; i < vectorCount; i += 4) {
+            __m128 x = _mm_mul_ps(_mm_loadu_ps(buffer + i), scale);
+            _mm_storeu_ps(buffer + i, _mm_mul_ps(ApplyCurve(type, x), unscale));
+        }
+
+        // Tail: pad to a full vector so it goes through the exact same math
+        if (vectorCount < count) {
+            float tail[4] = {};
+            int remaining = count - vectorCount;
+            for (int i = 0; i < remaining; i++) tail[i] = buffer[vectorCount + i];
+            __m128 x = _mm_mul_ps(_mm_loadu_ps(tail), scale);
+            _mm_storeu_ps(tail, _mm_mul_ps(ApplyCurve(type, x), unscale));
+            for (int i = 0; i < remaining; i++) buffer[vectorCount + i] = tail[i];
+        }
+        return;
+    }
+
+    // ADAA: every lane needs the previous *input* of its own channel. The previous
+    // input vector is kept around and shifted into place with shuffles, since the
+    // buffer itself is overwritten with outputs as we go.
+    const int frameChannels = channels;
+    __m128 prevVec = frameChannels == 1
+        ? _mm_set_ps(prevInput[0] * (1.0f / ceiling), 0.0f, 0.0f, 0.0f)
+        : _mm_set_ps(prevInput[1] * (1.0f / ceiling), prevInput[0] * (1.0f / ceiling), 0.0f, 0.0f);
+
+    for (int i = 0; i < vectorCount; i += 4) {
+        __m128 x = _mm_mul_ps(_mm_loadu_ps(buffer + i), scale);
+        __m128 prev;
+        if (frameChannels == 1) {
+            // [prev3, x0, x1, x2]
+            __m128 t = _mm_shuffle_ps(prevVec, x, _MM_SHUFFLE(0, 0, 3, 3));
+            prev = _mm_shuffle_ps(t, x, _MM_SHUFFLE(2, 1, 2, 0));
+        }
+        else {
+            // [prev2, prev3, x0, x1]
+            prev = _mm_shuffle_ps(prevVec, x, _MM_SHUFFLE(1, 0, 3, 2));
+        }
+
+        _mm_storeu_ps(buffer + i, _mm_mul_ps(HardClipAdaa(x, prev), unscale));
+        prevVec = x;
+    }
+
+    // Carry the last inputs of each channel over to the tail / next block
+    float lastInputs[4];
+    _mm_storeu_ps(lastInputs, _mm_mul_ps(prevVec, unscale));
+    if (vectorCount > 0) {
+        for (int ch = 0; ch < frameChannels; ch++) {
+            prevInput[ch] = lastInputs[4 - frameChannels + ch];
+        }
+    }
+
+    // Scalar tail with the same formula
+    for (int i = vectorCount; i < count; i++) {
+        int ch = i % frameChannels;
+        float in = buffer[i];
+        float out[4];
+        _mm_storeu_ps(out, _mm_mul_ps(HardClipAdaa(_mm_set1_ps(in / ceiling), _mm_set1_ps(prevInput[ch] / ceiling)), unscale));
+        buffer[i] = out[0];
+        prevInput[ch] = in;
+    }
+}
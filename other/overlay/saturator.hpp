@@ -0,0 +1,39 @@
+#pragma once
+
+// Saturator curves, in the order shown in the UI
+enum class SaturatorType : int {
+    Cubic = 0,      // x - 4x^3/27, unity slope, softest knee
+    Tanh,           // Pade tanh approximation
+    Arctan,         // Polynomial arctan approximation, longest tail
+    HardClip,       // Hard clip with first order antiderivative anti-aliasing (ADAA)
+    Count
+};
+
+// Saturator - branchless soft clipper family for interleaved float audio.
+//
+// Every curve is written with min/max/and/or only, so a whole frame runs through
+// SSE registers four samples at a time with no per-sample branches. Output never
+// exceeds +-ceiling. The ADAA hard clip needs the previous input of each channel,
+// which is kept between blocks.
+class Saturator {
+public:
+    static constexpr int MAX_CHANNELS = 2;
+
+    // Display names, indexed by SaturatorType
+    static const char* const NAMES[(int)SaturatorType::Count];
+
+    Saturator() = default;
+
+    // Change curve or channel layout, clears the ADAA history when either changes
+    void configure(SaturatorType newType, int numChannels);
+
+    void reset();
+
+    // Saturate `count` interleaved samples in place, limited to +-ceiling
+    void process(float* buffer, int count, float ceiling);
+
+private:
+    SaturatorType type = SaturatorType::Tanh;
+    int channels = 1;
+    float prevInput[MAX_CHANNELS] = {};
+};
@@ -0,0 +1,188 @@
+#include "streamMixer.hpp"
+#include <emmintrin.h>
+#include <algorithm> // For std::min, std::max
+#include <cmath>     // For powf, fabsf
+#include <cstring>   // For memcpy, memset
+
+void StreamMixer::configure(int rate) {
+    if (rate == sampleRate) return;
+    sampleRate = rate;
+    limiter.configure(sampleRate, 2, PeakLimiter::MIN_LOOKAHEAD_MS);
+    limiter.setSidechainLatency(TruePeakDetector::LATENCY);
+    limiter.reset();
+    limiterSidechain.configure(2);
+    limiterSidechain.reset();
+    flushFrames = 0;
+}
+
+int StreamMixer::addStream() {
+    for (int id = 0; id < MAX_STREAMS; id++) {
+        Stream& stream = streams[id];
+        if (stream.used) continue;
+
+        stream.used = true;
+        stream.left = stream.right = 1.0f;
+        stream.fresh = false;
+        stream.quietTicks = 0;
+        stream.activeIndex = -1;
+        streamCount++;
+        return id;
+    }
+    return -1;
+}
+
+void StreamMixer::removeStream(int id) {
+    if (id < 0 || id >= MAX_STREAMS || !streams[id].used) return;
+    deactivate(id);
+    streams[id].used = false;
+    streamCount--;
+}
+
+void StreamMixer::setGainPan(int id, float gainDb, float pan) {
+    if (id < 0 || id >= MAX_STREAMS) return;
+    PanGains(gainDb, pan, streams[id].left, streams[id].right);
+}
+
+void StreamMixer::activate(int id) {
+    Stream& stream = streams[id];
+    if (stream.activeIndex >= 0) return;
+    stream.activeIndex = activeCount;
+    active[activeCount++] = id;
+}
+
+void StreamMixer::deactivate(int id) {
+    Stream& stream = streams[id];
+    if (stream.activeIndex < 0) return;
+
+    // The last active voice takes the freed place
+    int last = active[--activeCount];
+    active[stream.activeIndex] = last;
+    streams[last].activeIndex = stream.activeIndex;
+    stream.activeIndex = -1;
+}
+
+void StreamMixer::submit(int id, const float* pcm, int frames, int channels) {
+    if (id < 0 || id >= MAX_STREAMS || !streams[id].used) return;
+    if (frames <= 0 || frames > MAX_FRAMES || channels < 1 || channels > 2) return;
+    Stream& stream = streams[id];
+
+    if (PeakAbs(pcm, frames * channels) < SILENCE_LEVEL) {
+        // Quiet voices keep playing through the hangover so word endings aren't cut
+        if (stream.activeIndex < 0) return;
+        if (++stream.quietTicks > HANGOVER_TICKS) {
+            deactivate(id);
+            return;
+        }
+    }
+    else {
+        stream.quietTicks = 0;
+        activate(id);
+    }
+
+    memcpy(stream.buffer, pcm, sizeof(float) * frames * channels);
+    stream.frames = frames;
+    stream.channels = channels;
+    stream.fresh = true;
+}
+
+int StreamMixer::mix(float* out, int frames) {
+    frames = std::max(0, std::min(frames, MAX_FRAMES));
+    memset(out, 0, sizeof(float) * frames * 2);
+
+    int mixed = 0;
+    for (int i = 0; i < activeCount; i++) {
+        Stream& stream = streams[active[i]];
+        if (!stream.fresh) continue;    // Talking, but nothing arrived this tick
+
+        AccumulateStereo(out, stream.buffer, std::min(frames, stream.frames), stream.channels, stream.left, stream.right);
+        stream.fresh = false;
+        mixed++;
+    }
+
+    if (sampleRate <= 0) return mixed;
+    if (mixed > 0) {
+        flushFrames = limiter.getLatency();
+    }
+    else if (flushFrames > 0) {
+        flushFrames = std::max(0, flushFrames - frames);
+    }
+    else {
+        return mixed;   // Delay line already holds silence
+    }
+
+    limiterSidechain.process(out, frames, truePeakLevels);
+    limiter.process(out, frames, truePeakLevels);
+    return mixed;
+}
+
+void PanGains(float gainDb, float pan, float& left, float& right) {
+    float gain = powf(10.0f, gainDb / 20.0f);
+    pan = std::max(-1.0f, std::min(pan, 1.0f));
+    left = gain * std::min(1.0f, 1.0f - pan);
+    right = gain * std::min(1.0f, 1.0f + pan);
+}
+
+void AccumulateStereo(float* bus, const float* in, int frames, int inChannels, float left, float right) {
+    const __m128 gains = _mm_setr_ps(left, right, left, right);
+    int i = 0;
+    if (inChannels == 2) {
+        int count = frames * 2;
+        for (; i + 8 <= count; i += 8) {
+            __m128 a = _mm_add_ps(_mm_loadu_ps(bus + i), _mm_mul_ps(_mm_loadu_ps(in + i), gains));
+            __m128 b = _mm_add_ps(_mm_loadu_ps(bus + i + 4), _mm_mul_ps(_mm_loadu_ps(in + i + 4), gains));
+            _mm_storeu_ps(bus + i, a);
+            _mm_storeu_ps(bus + i + 4, b);
+        }
+        for (; i < count; i += 2) {
+            bus[i] += in[i] * left;
+            bus[i + 1] += in[i + 1] * right;
+        }
+        return;
+    }
+
+    // Mono: duplicate four samples into two stereo vectors
+    for (; i + 4 <= frames; i += 4) {
+        __m128 mono = _mm_loadu_ps(in + i);
+        __m128 low = _mm_mul_ps(_mm_unpacklo_ps(mono, mono), gains);
+        __m128 high = _mm_mul_ps(_mm_unpackhi_ps(mono, mono), gains);
+        _mm_storeu_ps(bus + i * 2, _mm_add_ps(_mm_loadu_ps(bus + i * 2), low));
+        _mm_storeu_ps(bus + i * 2 + 4, _mm_add_ps(_mm_loadu_ps(bus + i * 2 + 4), high));
+    }
+    for (; i < frames; i++) {
+        bus[i * 2] += in[i] * left;
+        bus[i * 2 + 1] += in[i] * right;
+    }
+}
+
+void ApplyGainPan(float* buffer, int frames, int channels, float left, float right) {
+    // A mono voice has nowhere to pan to, it gets the louder side's gain
+    if (channels != 2) {
+        left = right = std::max(left, right);
+    }
+    const __m128 gains = _mm_setr_ps(left, right, left, right);
+    int count = frames * channels;
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(buffer + i, _mm_mul_ps(_mm_loadu_ps(buffer + i), gains));
+    }
+    // count is even for stereo, so the tail starts on a left sample
+    for (; i < count; i++) {
+        buffer[i] *= (channels == 2 && (i & 1)) ? right : left;
+    }
+}
+
+float PeakAbs(const float* in, int count) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 peak = _mm_setzero_ps();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        peak = _mm_max_ps(peak, _mm_and_ps(_mm_loadu_ps(in + i), absMask));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, peak);
+    float result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    for (; i < count; i++) {
+        result = std::max(result, fabsf(in[i]));
+    }
+    return result;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "peakLimiter.hpp"
+#include "truePeak.hpp"
+
+// StreamMixer - sums decoded incoming voices into one stereo bus.
+//
+// Every voice is a fixed slot with its own gain and pan. submit() hands over the
+// voice's decoded frame for this tick; a voice whose frames stay below
+// SILENCE_LEVEL for HANGOVER_TICKS ticks drops out of the active list (swapped
+// with the last entry, O(1)) and a loud frame puts it back (appended, O(1)). mix()
+// only walks the active list, so its cost follows the number of people talking,
+// not the number connected. The pan is folded into per-channel gains and the sum
+// is done with SSE, mono voices are spread over both channels in the same pass.
+// One look-ahead limiter with a true-peak sidechain sits on the bus.
+//
+// All storage is fixed size, nothing allocates after construction. A mixer is
+// driven by one thread; the object is large, keep it on the heap or in statics.
+class StreamMixer {
+public:
+    static constexpr int MAX_STREAMS = 64;
+    static constexpr int MAX_FRAMES = 2880;         // 60 ms at 48 kHz, per channel
+    static constexpr float SILENCE_LEVEL = 0.001f;  // -60 dBFS peak, below is treated as not talking
+    static constexpr int HANGOVER_TICKS = 10;       // Quiet ticks before a voice leaves the active list
+
+    StreamMixer() = default;
+    StreamMixer(const StreamMixer&) = delete;
+    StreamMixer& operator=(const StreamMixer&) = delete;
+
+    // Set the bus sample rate, clears the limiter when it changes
+    void configure(int sampleRate);
+
+    // Claim a slot for a new voice, -1 when all are taken
+    int addStream();
+
+    void removeStream(int id);
+
+    // Voice gain in dB and pan from -1 (left) to 1 (right)
+    void setGainPan(int id, float gainDb, float pan);
+
+    // Hand over one decoded frame of a voice, interleaved mono or stereo
+    void submit(int id, const float* pcm, int frames, int channels);
+
+    // Sum the frames submitted since the last mix into out (stereo interleaved,
+    // frames long) and limit the bus. The limiter keeps running on silence for one
+    // look-ahead after the last voice so the end of a spurt comes out of its delay
+    // line. Returns the number of voices mixed.
+    int mix(float* out, int frames);
+
+    int getActiveCount() const { return activeCount; }
+    int getStreamCount() const { return streamCount; }
+
+private:
+    struct Stream {
+        bool used = false;
+        float left = 1.0f;      // Gain and pan folded together
+        float right = 1.0f;
+        int channels = 0;
+        int frames = 0;
+        bool fresh = false;     // Submitted since the last mix
+        int quietTicks = 0;
+        int activeIndex = -1;   // Position in the active list, -1 when idle
+        float buffer[MAX_FRAMES * 2];
+    };
+
+    Stream streams[MAX_STREAMS];
+    int active[MAX_STREAMS] = {};
+    int activeCount = 0;
+    int streamCount = 0;
+
+    PeakLimiter limiter;
+    TruePeakDetector limiterSidechain;
+    float truePeakLevels[MAX_FRAMES] = {};
+    int flushFrames = 0;        // Silent frames still owed to the limiter so its delay line drains
+    int sampleRate = 0;
+
+    void activate(int id);
+    void deactivate(int id);
+};
+
+// Per-channel gains for a voice: balance law, so the center is unity and turning
+// the pan only ever takes level away from the far side
+void PanGains(float gainDb, float pan, float& left, float& right);
+
+// bus (stereo interleaved) += in * (left, right). A mono input feeds both channels. SSE.
+void AccumulateStereo(float* bus, const float* in, int frames, int inChannels, float left, float right);
+
+// In place gain and pan on a mono or stereo frame, mono only takes the gain. SSE.
+void ApplyGainPan(float* buffer, int frames, int channels, float left, float right);
+
+// Largest absolute sample, SSE
+float PeakAbs(const float* in, int count);
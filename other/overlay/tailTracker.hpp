@@ -0,0 +1,76 @@
+#pragma once
+
+// TailTracker - decides when a stateful effect (reverb, delay, filters with memory)
+// can stop processing. The effect reports the energy of every block it sees on its
+// input and produces on its output; once both have stayed below the threshold for
+// longer than the effect's longest internal delay, whatever is left in its buffers
+// is inaudible and the stage can go to sleep until the input becomes non-silent again.
+class TailTracker {
+public:
+    // Mean square level treated as silence (~-80 dBFS)
+    static constexpr float DEFAULT_THRESHOLD = 1.0e-8f;
+
+    TailTracker() = default;
+
+    // tailSamples: how long input and output must stay quiet before sleeping,
+    // normally the longest path through the effect's delay lines
+    void configure(int tailSamples, float thresholdMeanSquare = DEFAULT_THRESHOLD) {
+        holdSamples = tailSamples > 0 ? tailSamples : 0;
+        threshold = thresholdMeanSquare;
+        quietSamples = 0;
+    }
+
+    // Mean square of a block - the energy measure used by update() and isSilent()
+    static float meanSquare(const float* buffer, int count) {
+        if (!buffer || count <= 0) return 0.0f;
+
+        float sum = 0.0f;
+        for (int i = 0; i < count; i++) {
+            sum += buffer[i] * buffer[i];
+        }
+        return sum / count;
+    }
+
+    bool isSilent(float meanSquareLevel) const {
+        return meanSquareLevel < threshold;
+    }
+
+    bool isSleeping() const {
+        return sleeping;
+    }
+
+    // Force the sleeping state, e.g. right after the effect's buffers were cleared
+    void sleep() {
+        sleeping = true;
+        quietSamples = 0;
+    }
+
+    void wake() {
+        sleeping = false;
+        quietSamples = 0;
+    }
+
+    // Report one processed block. Returns true when the effect has just gone to sleep,
+    // so the caller can flush its (now inaudible) buffers once.
+    bool update(float inputMeanSquare, float outputMeanSquare, int numSamples) {
+        if (sleeping) return false;
+
+        if (isSilent(inputMeanSquare) && isSilent(outputMeanSquare)) {
+            quietSamples += numSamples;
+            if (quietSamples >= holdSamples) {
+                sleep();
+                return true;
+            }
+        }
+        else {
+            quietSamples = 0;
+        }
+        return false;
+    }
+
+private:
+    float threshold = DEFAULT_THRESHOLD;
+    int holdSamples = 0;
+    int quietSamples = 0;
+    bool sleeping = false;
+};
@@ -0,0 +1,81 @@
+#include "truePeak.hpp"
+#include <algorithm> // For std::min, std::max
+#include <cstring>   // For memset
+
+namespace {
+    // BS.1770-4 interpolation filter, transposed: row k holds tap k of phases 0-3
+    alignas(16) const float TRUE_PEAK_COEFFS[TruePeakDetector::TAPS][TruePeakDetector::PHASES] = {
+        {  0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f },
+        {  0.0109863281250f,  0.0292968750000f,  0.0330810546875f,  0.0148925781250f },
+        { -0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f },
+        {  0.0332031250000f,  0.0891113281250f,  0.1015625000000f,  0.0476074218750f },
+        { -0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f },
+        {  0.1373291015625f,  0.4650878906250f,  0.7797851562500f,  0.9721679687500f },
+        {  0.9721679687500f,  0.7797851562500f,  0.4650878906250f,  0.1373291015625f },
+        { -0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f },
+        {  0.0476074218750f,  0.1015625000000f,  0.0891113281250f,  0.0332031250000f },
+        { -0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f },
+        {  0.0148925781250f,  0.0330810546875f,  0.0292968750000f,  0.0109863281250f },
+        { -0.0083007812500f, -0.0189208984375f, -0.0291748046875f,  0.0017089843750f },
+    };
+}
+
+void TruePeakDetector::configure(int numChannels) {
+    numChannels = std::max(1, std::min(numChannels, MAX_CHANNELS));
+    if (numChannels == channels) return;
+
+    channels = numChannels;
+    reset();
+}
+
+void TruePeakDetector::reset() {
+    memset(history, 0, sizeof(history));
+    historyPos = 0;
+}
+
+float TruePeakDetector::process(const float* buffer, int frames, float* framePeaks) {
+    if (!buffer || frames <= 0) return 0.0f;
+
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 coeffs[TAPS];
+    for (int k = 0; k < TAPS; k++) {
+        coeffs[k] = _mm_load_ps(TRUE_PEAK_COEFFS[k]);
+    }
+
+    __m128 blockPeak = _mm_setzero_ps();
+
+    for (int i = 0; i < frames; i++) {
+        __m128 framePeak = _mm_setzero_ps();
+
+        for (int ch = 0; ch < channels; ch++) {
+            float* line = history[ch];
+            float sample = buffer[i * channels + ch];
+            line[historyPos] = sample;
+            line[historyPos + TAPS] = sample;
+
+            // Newest sample sits at historyPos + TAPS, oldest at historyPos + 1
+            const float* newest = line + historyPos + TAPS;
+            __m128 acc = _mm_mul_ps(coeffs[0], _mm_set1_ps(newest[0]));
+            for (int k = 1; k < TAPS; k++) {
+                acc = _mm_add_ps(acc, _mm_mul_ps(coeffs[k], _mm_set1_ps(newest[-k])));
+            }
+
+            framePeak = _mm_max_ps(framePeak, _mm_and_ps(acc, absMask));
+        }
+
+        if (++historyPos >= TAPS) historyPos = 0;
+
+        blockPeak = _mm_max_ps(blockPeak, framePeak);
+
+        if (framePeaks) {
+            // Horizontal max of the four interpolated points
+            __m128 m = _mm_max_ps(framePeak, _mm_movehl_ps(framePeak, framePeak));
+            m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+            framePeaks[i] = _mm_cvtss_f32(m);
+        }
+    }
+
+    __m128 m = _mm_max_ps(blockPeak, _mm_movehl_ps(blockPeak, blockPeak));
+    m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 1));
+    return _mm_cvtss_f32(m);
+}